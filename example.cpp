@@ -35,6 +35,15 @@
 #include <QMetaObject>
 #include <QCoreApplication>
 #include <iostream>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <string>
 
 static void _testing_task_await() ;
 static void _testing_task_future_all() ;
@@ -50,24 +59,66 @@ static void _print( const T& e )
 	std::cout << e << std::endl ;
 }
 
+/*
+ * Tests that check results stop the program if a result is not what it should be.
+ */
+static void _check( bool e,const char * s )
+{
+	if( !e ){
+
+		std::cout << "Failed: " << s << std::endl ;
+
+		std::abort() ;
+	}
+}
+
+/*
+ * Returns a function that blocks until "n" callers reach it,callers that get true ran at
+ * the same time. Tests use it instead of timing to tell that tasks ran concurrently and the
+ * generous timeout only keeps a broken build from hanging.
+ */
+static std::function< bool() > _rendezvous( int n )
+{
+	auto s = std::make_shared< QSemaphore >() ;
+
+	return [ s,n ](){
+
+		s->release() ;
+
+		if( s->tryAcquire( n,30000 ) ){
+
+			s->release( n ) ;
+
+			return true ;
+		}else{
+			return false ;
+		}
+	} ;
+}
+
 struct wait{
 
 	void task_finished( const char * s )
 	{
-		QMutexLocker m( &mutex ) ;
+		/*
+		 * Tasks call this function from their own threads,the count is kept on the
+		 * thread of the loop so that a task is done with this object before the loop
+		 * can exit and the object goes away.
+		 */
+		QMetaObject::invokeMethod( &loop,[ this,s ](){
 
-		counter++ ;
+			counter++ ;
 
-		std::cout << s << std::endl ;
+			std::cout << s << std::endl ;
 
-		if( counter == max ){
+			if( counter == max ){
 
-			loop.exit() ;
-		}
+				loop.exit() ;
+			}
+		},Qt::QueuedConnection ) ;
 	}
 	int max = 3 ;
 	int counter = 0 ;
-	QMutex mutex ;
 	QEventLoop loop ;
 };
 
@@ -486,108 +537,1662 @@ static void _test_move_only_callables()
 			 Task::run( [ a = std::unique_ptr<int>() ](){} ) ).get() ;
 }
 
-static void _test_copyable_callables()
+static void _test_thread_pool()
 {
-	auto aa = []( int x ){ return x ; } ;
+	_print( "Testing Task::backend::thread_pool" ) ;
 
-	auto bb = [](){	return 6 ; } ;
+	Task::thread_pool().setMaxThreadCount( 2 ) ;
 
-	auto cc = [](){} ;
+	int r = Task::run( Task::backend::thread_pool,[](){ _printThreadID() ; return 6 ; } ).await() ;
 
-	auto dd = [](int){} ;
+	_print( r ) ;
 
-	Task::run( aa,4 ).get() ;
-	Task::run( dd,4 ).get() ;
+	Task::run_tasks( Task::backend::thread_pool,
+			 [](){ _printThreadID() ; },
+			 [](){ _printThreadID() ; },
+			 [](){ _printThreadID() ; } ).await() ;
+}
 
-	Task::run( bb ).get() ;
-	Task::run( cc ).get() ;
+static void _test_when_all()
+{
+	_print( "Testing Task::when_all()" ) ;
 
-	Task::await( bb ) ;
+	auto& a = Task::run( [](){ QThread::msleep( 50 ) ; return 1 ; } ) ;
+	auto& b = Task::run( [](){ return 2 ; } ) ;
+	auto& c = Task::run( [](){ return 3 ; } ) ;
 
-	auto& tt = Task::run( bb ) ;
+	auto v = Task::when_all( a,b,c ).await() ;
 
-	Task::await( tt ) ;
-	Task::await( Task::run( cc ) ) ;
+	_check( v == std::vector< int >{ 1,2,3 },"results are in the order the futures were given" ) ;
 
-	Task::await( aa,4 ) ;
+	auto& d = Task::run( [](){ return 4 ; } ) ;
+	auto& e = Task::run( [](){ return QString( "abc" ) ; } ) ;
 
-	Task::await( dd,4 ) ;
+	auto t = Task::when_all( d,e ).await() ;
 
-	Task::await( bb ) ;
+	_check( std::get< 0 >( t ) == 4 && std::get< 1 >( t ) == "abc","results of different types are in a tuple" ) ;
 
-	Task::await( cc ) ;
+	QThread thread ;
 
-	auto& zz = Task::run( bb ) ;
+	thread.start() ;
 
-	Task::await( zz ) ;
-	Task::await( Task::run( cc ) ) ;
+	QObject context ;
 
-	Task::exec( aa,4 ) ;
-	Task::exec( dd,4 ) ;
+	context.moveToThread( &thread ) ;
 
-	Task::exec( bb ) ;
-	Task::exec( cc ) ;
+	QSemaphore s ;
 
-	Task::run_tasks( bb,bb,cc ).get() ;
+	QThread * where = nullptr ;
 
-	Task::run_tasks( Task::run( cc ),Task::run( cc ) ).get() ;
+	std::vector< Task::future< int > * > m ;
+
+	for( int i = 0 ; i < 10 ; i++ ){
+
+		m.emplace_back( &Task::run( [ i ](){ return i ; } ) ) ;
+	}
+
+	Task::when_all( m ).then( &context,[ & ]( std::vector< int > e ){
+
+		_check( e.size() == 10 && e[ 9 ] == 9,"results of a range of futures were collected" ) ;
+
+		where = QThread::currentThread() ;
+
+		s.release() ;
+	} ) ;
+
+	s.acquire() ;
+
+	_check( where == &thread,"continuation ran on the thread of the context" ) ;
+
+	thread.quit() ;
+	thread.wait() ;
 }
 
-struct foo
+static void _test_wait()
 {
-	foo()
-	{
-	}
-	foo(int a)
-	{
-		_print(a);
-	}
-	std::unique_ptr<int> m ;
-};
+	_print( "Testing future::wait()" ) ;
 
-struct www
+	std::atomic< int > together( 0 ) ;
+
+	auto meet = _rendezvous( 4 ) ;
+
+	auto task = [ & ](){ together += meet() ? 1 : 0 ; } ;
+
+	auto& a = Task::run_tasks( Task::backend::thread,task,task ) ;
+	auto& b = Task::run_tasks( Task::backend::thread,task ) ;
+
+	Task::run_tasks( a,b,Task::run( Task::backend::thread,task ) ).wait() ;
+
+	_check( together == 4,"futures that manage other futures ran concurrently" ) ;
+
+	std::vector< int > order ;
+
+	bool main_thread = true ;
+
+	auto pair = [ & ]( int e ){
+
+		return Task::make_pair( [](){},[ &,e ](){
+
+			order.emplace_back( e ) ;
+
+			main_thread = main_thread && QThread::currentThread() == QCoreApplication::instance()->thread() ;
+		} ) ;
+	} ;
+
+	auto& c = Task::run( pair( 1 ),pair( 2 ) ) ;
+	auto& d = Task::run( pair( 3 ) ) ;
+
+	Task::run_tasks( c,d ).wait() ;
+
+	_check( order == std::vector< int >{ 1,2,3 },"continuations of pairs ran in order" ) ;
+
+	_check( main_thread,"continuations of pairs ran on the calling thread" ) ;
+
+	auto meet_two = _rendezvous( 2 ) ;
+
+	auto& e = Task::run( Task::backend::thread,[ meet_two ](){ return meet_two() ? 1 : 0 ; } ) ;
+	auto& f = Task::run( Task::backend::thread,[ meet_two ](){ return meet_two() ? 2 : 0 ; } ) ;
+
+	auto v = Task::when_all( e,f ).wait() ;
+
+	_check( v == std::vector< int >{ 1,2 },"futures of Task::when_all() ran concurrently" ) ;
+
+	/*
+	 * Managed tasks would be queued behind a blocked thread that is the only thread of
+	 * its pool,wait() runs them on it instead.
+	 */
+	auto nested = []( Task::backend backend ){
+
+		auto thread = QThread::currentThread() ;
+
+		std::atomic< int > here( 0 ) ;
+
+		auto task = [ & ](){ here += QThread::currentThread() == thread ? 1 : 0 ; } ;
+
+		Task::run_tasks( Task::run( backend,task ),Task::run( backend,task ) ).wait() ;
+
+		auto value = [ & ](){ task() ; return 1 ; } ;
+
+		auto m = Task::when_all( Task::run( backend,value ),Task::run( backend,value ) ).wait() ;
+
+		return here.load() + static_cast< int >( m.size() ) ;
+	} ;
+
+	QSemaphore s ;
+
+	int result = 0 ;
+
+	Task::scheduler one( 1 ) ;
+
+	Task::exec( one,[ & ](){
+
+		result = nested( Task::backend::work_stealing ) ;
+
+		s.release() ;
+	} ) ;
+
+	s.acquire() ;
+
+	_check( result == 6,"wait() on the only worker of a scheduler ran managed tasks on it" ) ;
+
+	auto max = Task::thread_pool().maxThreadCount() ;
+
+	Task::thread_pool().setMaxThreadCount( 1 ) ;
+
+	Task::exec( Task::backend::thread_pool,[ & ](){
+
+		result = nested( Task::backend::thread_pool ) ;
+
+		s.release() ;
+	} ) ;
+
+	s.acquire() ;
+
+	Task::thread_pool().setMaxThreadCount( max ) ;
+
+	_check( result == 6,"wait() on the only thread of Task::thread_pool() ran managed tasks on it" ) ;
+}
+
+static void _test_then_with_context()
 {
-	void operator()()
-	{
+	_print( "Testing .then() with a context object and Task::inline_continuation" ) ;
 
+	QThread thread ;
+
+	thread.start() ;
+
+	QObject context ;
+
+	context.moveToThread( &thread ) ;
+
+	QSemaphore s ;
+
+	QThread * where = nullptr ;
+
+	Task::run( [](){ return 7 ; } ).then( &context,[ & ]( int e ){
+
+		_check( e == 7,"continuation got the result of the task" ) ;
+
+		where = QThread::currentThread() ;
+
+		s.release() ;
+	} ) ;
+
+	s.acquire() ;
+
+	_check( where == &thread,"continuation ran on the thread of the context" ) ;
+
+	Task::run( [](){} ).then( Task::inline_continuation,[ & ](){
+
+		where = QThread::currentThread() ;
+
+		s.release() ;
+	} ) ;
+
+	s.acquire() ;
+
+	_check( where != QThread::currentThread() && where != &thread,"continuation ran on the worker" ) ;
+
+	/*
+	 * The context is deleted before the tasks finish. The continuation is dropped but the
+	 * future that manages the tasks still starts the next one.
+	 */
+	std::atomic< bool > called( false ) ;
+
+	QSemaphore gate ;
+
+	auto e = new QObject() ;
+
+	Task::run_tasks( [ & ](){ gate.acquire() ; },[ & ](){ s.release() ; } ).max_in_flight( 1 ).then( e,[ & ](){ called = true ; } ) ;
+
+	delete e ;
+
+	gate.release() ;
+
+	s.acquire() ;
+
+	_check( !called,"continuation of a deleted context was dropped" ) ;
+
+	thread.quit() ;
+	thread.wait() ;
+}
+
+static void _test_typed_progress()
+{
+	_print( "Testing Task::typed_progress" ) ;
+
+	QObject receiver ;
+
+	std::vector< int > values ;
+
+	bool main_thread = true ;
+
+	auto bg = []( const Task::typed_progress< int >& p ){
+
+		for( int i = 0 ; i < 1000 ; i++ ){
+
+			p.update( i ) ;
+		}
+	} ;
+
+	Task::run< int >( &receiver,bg,[ & ]( int e ){
+
+		values.push_back( e ) ;
+
+		main_thread = main_thread && QThread::currentThread() == receiver.thread() ;
+
+	} ).await() ;
+
+	_check( values.size() == 1000,"all values were delivered" ) ;
+
+	for( int i = 0 ; i < 1000 ; i++ ){
+
+		_check( values[ i ] == i,"values were delivered in order" ) ;
 	}
-	www( const www& )
-	{
-		_print( "const www&" ) ;
-	}
-	www( www&& )
-	{
-		_print( "www&&" ) ;
-	}
-	www()
-	{
-		_print( "www()" ) ;
-	}
-	www& operator=( const www& )
-	{
-		_print( "www& operator=( const www& )" ) ;
 
-		return *this ;
+	_check( main_thread,"values were delivered on the thread of the receiver" ) ;
+
+	/*
+	 * The receiver is deleted while the task still reports and the rest of the values are dropped.
+	 */
+	auto e = new QObject() ;
+
+	int count = 0 ;
+
+	QEventLoop loop ;
+
+	Task::run< int >( e,[]( const Task::typed_progress< int >& p ){
+
+		for( int i = 0 ; i < 20 ; i++ ){
+
+			p.update( i ) ;
+
+			QThread::msleep( 10 ) ;
+		}
+
+	},[ & ]( int ){ count++ ; } ).then( [ & ](){ loop.exit() ; } ) ;
+
+	QThread::msleep( 50 ) ;
+
+	delete e ;
+
+	auto m = count ;
+
+	loop.exec() ;
+
+	_check( count == m,"values were not delivered to a deleted receiver" ) ;
+}
+
+static void _test_coalesced_progress()
+{
+	_print( "Testing Task::typed_progress with an interval" ) ;
+
+	QObject receiver ;
+
+	std::vector< int > values ;
+
+	auto bg = []( const Task::typed_progress< int >& p ){
+
+		for( int i = 0 ; i <= 100000 ; i++ ){
+
+			p.update( i ) ;
+
+			if( i % 10000 == 0 ){
+
+				QThread::msleep( 10 ) ;
+			}
+		}
+	} ;
+
+	auto interval = std::chrono::milliseconds( 50 ) ;
+
+	Task::run< int >( &receiver,bg,[ & ]( int e ){ values.push_back( e ) ; },interval ).await() ;
+
+	/*
+	 * The last value may wait for the interval to pass.
+	 */
+	for( int i = 0 ; i < 100 && ( values.empty() || values.back() != 100000 ) ; i++ ){
+
+		QThread::msleep( 10 ) ;
+
+		QCoreApplication::processEvents() ;
 	}
-	www& operator=( www&& )
-	{
-		_print( "www& operator=( www&& )" ) ;
 
-		return *this ;
+	_check( !values.empty() && values.back() == 100000,"the last value was delivered" ) ;
+
+	_check( values.size() < 10,"values were coalesced" ) ;
+
+	for( std::size_t i = 1 ; i < values.size() ; i++ ){
+
+		_check( values[ i - 1 ] < values[ i ],"values were delivered in order" ) ;
 	}
 
-	std::unique_ptr<int> m ;
-};
+	/*
+	 * The receiver is deleted while the task still reports.
+	 */
+	auto e = new QObject() ;
 
-void example::run()
-{
-#if __cplusplus >= 201703L
+	int count = 0 ;
 
-	Task::await([](foo,foo,foo){},foo(7),foo(7),foo(7));
-#endif
-	_test_copyable_callables() ;
+	QEventLoop loop ;
 
-	_test_move_only_callables() ;
+	Task::run< int >( e,[]( const Task::typed_progress< int >& p ){
+
+		for( int i = 0 ; i < 20 ; i++ ){
+
+			p.update( i ) ;
+
+			QThread::msleep( 10 ) ;
+		}
+
+	},[ & ]( int ){ count++ ; },std::chrono::milliseconds( 0 ) ).then( [ & ](){ loop.exit() ; } ) ;
+
+	QThread::msleep( 50 ) ;
+
+	delete e ;
+
+	auto m = count ;
+
+	loop.exec() ;
+
+	_check( count == m,"values were not delivered to a deleted receiver" ) ;
+}
+
+static void _test_process_stream()
+{
+	_print( "Testing Task::process::stream" ) ;
+
+	QObject context ;
+
+	std::vector< QByteArray > lines ;
+
+	bool main_thread = true ;
+
+	Task::process::stream s ;
+
+	s.lines().std_out( &context,[ & ]( const QByteArray& e ){
+
+		lines.emplace_back( e ) ;
+
+		main_thread = main_thread && QThread::currentThread() == context.thread() ;
+	} ) ;
+
+	auto r = Task::process::run( "sh",{ "-c","printf 'a\\nbb\\n\\nccc'" },s ).await() ;
+
+	_check( r.success() && r.std_out().isEmpty(),"streamed output is not kept in the result" ) ;
+
+	_check( lines == std::vector< QByteArray >{ "a","bb","","ccc" },"output was delivered one line at a time" ) ;
+
+	_check( main_thread,"output was delivered on the thread of the context" ) ;
+
+	Task::process::stream c ;
+
+	c.cap( 4 ) ;
+
+	_check( Task::process::run( "sh",{ "-c","echo abcdefgh" },c ).await().std_out() == "abcd","output was capped" ) ;
+
+	std::vector< QByteArray > cut ;
+
+	Task::process::stream l ;
+
+	l.lines().cap( 3 ).std_out( [ & ]( const QByteArray& e ){ cut.emplace_back( e ) ; } ) ;
+
+	Task::process::run( "sh",{ "-c","printf 'abcdefgh\\nxy\\nlonger'" },l ).await() ;
+
+	_check( cut == std::vector< QByteArray >{ "abc","xy","lon" },"lines were cut to the cap" ) ;
+
+	Task::process::stream f ;
+
+	f.std_out_file( "/nonexistent/out.txt" ) ;
+
+	auto x = Task::process::run( "sh",{ "-c","echo abc" },f ).await() ;
+
+	_check( !x.success() && x.std_out().isEmpty() && !x.error().isEmpty(),"a file that could not be opened was reported" ) ;
+
+	/*
+	 * The context is deleted while the process still writes.
+	 */
+	auto e = new QObject() ;
+
+	int count = 0 ;
+
+	Task::process::stream d ;
+
+	d.lines().std_out( e,[ & ]( const QByteArray& ){ count++ ; } ) ;
+
+	QEventLoop loop ;
+
+	Task::process::run( "sh",{ "-c","for i in 1 2 3 4 5 6 7 8 9 10; do echo $i; sleep 0.02; done" },d ).then( [ & ]( const Task::process::result& ){
+
+		loop.exit() ;
+	} ) ;
+
+	QThread::msleep( 50 ) ;
+
+	delete e ;
+
+	auto m = count ;
+
+	loop.exec() ;
+
+	_check( count == m,"output was not delivered to a deleted context" ) ;
+}
+
+#if __cplusplus > 201703L
+
+static Task::coroutine< int > _coroutine_add( int a,int b )
+{
+	int x = co_await Task::run( [ a ](){ return a ; } ) ;
+
+	_check( QThread::currentThread() == QCoreApplication::instance()->thread(),"coroutine resumed on the thread that started it" ) ;
+
+	int y = co_await Task::run( Task::backend::thread_pool,[ b ](){ return b ; } ) ;
+
+	_check( QThread::currentThread() == QCoreApplication::instance()->thread(),"coroutine resumed on the thread that started it" ) ;
+
+	co_return x + y ;
+}
+
+static Task::coroutine< long > _coroutine_depth( long n )
+{
+	if( n == 0 ){
+
+		co_return 0 ;
+	}
+
+	co_return 1 + co_await _coroutine_depth( n - 1 ) ;
+}
+
+static Task::coroutine< int > _coroutine_throw()
+{
+	co_await Task::run( [](){} ) ;
+
+	throw std::runtime_error( "coroutine" ) ;
+}
+
+static Task::coroutine< int > _coroutine_catch()
+{
+	try{
+		co_await _coroutine_throw() ;
+
+	}catch( const std::runtime_error& e ){
+
+		_check( std::string( e.what() ) == "coroutine","co_await rethrew the exception of an awaited coroutine" ) ;
+
+		co_return 1 ;
+	}
+
+	co_return 0 ;
+}
+
+static void _test_coroutines()
+{
+	_print( "Testing Task::coroutine" ) ;
+
+	_check( _coroutine_add( 2,3 ).await() == 5,"coroutine returned the sum of awaited futures" ) ;
+
+	_check( _coroutine_depth( 2000 ).await() == 2000,"a chain of awaiting coroutines completed" ) ;
+
+	_check( _coroutine_catch().await() == 1,"an exception was caught inside a coroutine" ) ;
+
+	bool caught = false ;
+
+	try{
+		_coroutine_throw().await() ;
+
+	}catch( const std::runtime_error& ){
+
+		caught = true ;
+	}
+
+	_check( caught,".await() rethrew the exception of a coroutine" ) ;
+
+	QEventLoop loop ;
+
+	int value = -1 ;
+
+	bool done = false ;
+
+	_coroutine_throw().then( [ & ]( int e ){
+
+		value = e ;
+
+		done = true ;
+
+		loop.exit() ;
+	} ) ;
+
+	if( !done ){
+
+		loop.exec() ;
+	}
+
+	_check( value == 0,".then() got a default constructed result from a coroutine that threw" ) ;
+}
+
+#endif
+
+static void _test_parallel_for()
+{
+	_print( "Testing Task::parallel_for() and Task::parallel_transform()" ) ;
+
+	std::vector< int > v( 100000 ) ;
+
+	Task::parallel_for( 0u,v.size(),[ & ]( std::size_t i ){ v[ i ] = static_cast< int >( i ) ; } ) ;
+
+	bool ok = true ;
+
+	for( std::size_t i = 0 ; i < v.size() ; i++ ){
+
+		ok = ok && v[ i ] == static_cast< int >( i ) ;
+	}
+
+	_check( ok,"every index was visited once" ) ;
+
+	Task::parallel_for( v,[]( int& e ){ e = e * 2 ; } ) ;
+
+	_check( v[ 1 ] == 2 && v[ 99999 ] == 199998,"every element was visited once" ) ;
+
+	auto m = Task::parallel_transform( v,[]( int e ){ return static_cast< char >( e % 3 == 0 ) ; } ) ;
+
+	_check( m.size() == v.size() && m[ 0 ] == 1 && m[ 1 ] == 0 && m[ 3 ] == 1,"results are in the order of the elements" ) ;
+
+	auto r = Task::run_parallel_transform( v,[]( int e ){ return e + 1 ; } ).await() ;
+
+	_check( r[ 0 ] == 1 && r[ 99999 ] == 199999,"results of a future are in the order of the elements" ) ;
+}
+
+static void _test_parallel_reduce()
+{
+	_print( "Testing Task::parallel_reduce()" ) ;
+
+	std::vector< long > v( 100000 ) ;
+
+	for( std::size_t i = 0 ; i < v.size() ; i++ ){
+
+		v[ i ] = static_cast< long >( i ) ;
+	}
+
+	auto sum = []( long a,long b ){ return a + b ; } ;
+
+	long a = Task::parallel_reduce( v,0L,[]( long e ){ return e ; },sum ).await() ;
+
+	_check( a == 99999L * 100000 / 2,"the partials of every worker were combined" ) ;
+
+	long b = Task::parallel_reduce( 0u,v.size(),0L,[]( std::size_t i ){ return static_cast< long >( i ) ; },sum ).await() ;
+
+	_check( b == a,"the partials of an index range were combined" ) ;
+
+	auto merge = []( std::vector< int > a,const std::vector< int >& b ){
+
+		for( std::size_t i = 0 ; i < a.size() ; i++ ){
+
+			a[ i ] += b[ i ] ;
+		}
+
+		return a ;
+	} ;
+
+	auto count = []( std::vector< int >& h,long e ){ h[ static_cast< std::size_t >( e % 10 ) ]++ ; } ;
+
+	auto h = Task::parallel_reduce( v,std::vector< int >( 10 ),count,merge ).await() ;
+
+	_check( h == std::vector< int >( 10,10000 ),"partials updated in place were combined" ) ;
+
+	bool empty = Task::parallel_reduce( std::vector< long >(),7L,[]( long e ){ return e ; },sum ).await() == 7 ;
+
+	_check( empty,"an empty container gives the identity" ) ;
+}
+
+static long _fork_sum( const std::vector< long >& v,std::size_t b,std::size_t e )
+{
+	if( e - b < 1000 ){
+
+		return std::accumulate( v.begin() + static_cast< std::ptrdiff_t >( b ),v.begin() + static_cast< std::ptrdiff_t >( e ),0L ) ;
+	}else{
+		auto m = b + ( e - b ) / 2 ;
+
+		auto left = Task::fork( [ &v,b,m ](){ return _fork_sum( v,b,m ) ; } ) ;
+
+		auto right = _fork_sum( v,m,e ) ;
+
+		return left.join() + right ;
+	}
+}
+
+static void _test_fork_join()
+{
+	_print( "Testing Task::fork()" ) ;
+
+	std::vector< long > v( 100000,1 ) ;
+
+	long sum = Task::run( Task::backend::work_stealing,[ & ](){ return _fork_sum( v,0,v.size() ) ; } ).await() ;
+
+	_check( sum == 100000,"the results of forked functions were joined" ) ;
+
+	Task::scheduler s( 1 ) ;
+
+	QSemaphore gate ;
+
+	auto busy = Task::fork( s,[ & ](){ gate.acquire() ; } ) ;
+
+	QThread * where = nullptr ;
+
+	auto mine = Task::fork( s,[ & ](){ where = QThread::currentThread() ; return 1 ; } ) ;
+
+	_check( mine.join() == 1 && where == QThread::currentThread(),"a thread that is not a worker ran its own forked function" ) ;
+
+	gate.release() ;
+
+	busy.join() ;
+
+	auto bad = Task::fork( s,[]()->int{ throw std::runtime_error( "fork" ) ; } ) ;
+
+	bool thrown = false ;
+
+	try{
+		bad.join() ;
+
+	}catch( const std::runtime_error& ){
+
+		thrown = true ;
+	}
+
+	_check( thrown,".join() threw the exception of the forked function" ) ;
+
+	thrown = false ;
+
+	try{
+		bad.join() ;
+
+	}catch( const std::future_error& ){
+
+		thrown = true ;
+	}
+
+	_check( thrown,"a second .join() threw std::future_error" ) ;
+
+	struct value
+	{
+		value( int x ) : e( x )
+		{
+		}
+		int e ;
+	};
+
+	_check( Task::fork( s,[](){ return value( 4 ) ; } ).join().e == 4,"a forked function returned a type that is not default constructible" ) ;
+}
+
+static void _test_io_thread()
+{
+	_print( "Testing Task::process::io_thread()" ) ;
+
+	auto& m = Task::process::io_thread() ;
+
+	auto dir = QString::fromUtf8( Task::process::run( m,"mktemp",{ "-d" } ).await().std_out().trimmed() ) ;
+
+	/*
+	 * Every process waits for all of them to start and prints its number only if they did.
+	 */
+	auto script = "touch %1/%2; n=0; while [ $(ls %1 | wc -l) -lt 4 ] && [ $n -lt 3000 ]; do sleep 0.01; n=$((n+1)); done; [ $(ls %1 | wc -l) -ge 4 ] && echo %2" ;
+
+	std::vector< Task::future< Task::process::result > * > e ;
+
+	for( int i = 0 ; i < 4 ; i++ ){
+
+		e.emplace_back( &Task::process::run( m,"sh",{ "-c",QString( script ).arg( dir,QString::number( i ) ) } ) ) ;
+	}
+
+	QThread * where = nullptr ;
+
+	std::vector< QByteArray > out ;
+
+	QEventLoop loop ;
+
+	Task::when_all( e ).then( [ & ]( std::vector< Task::process::result > r ){
+
+		where = QThread::currentThread() ;
+
+		for( const auto& it : r ){
+
+			out.emplace_back( it.std_out().trimmed() ) ;
+		}
+
+		loop.exit() ;
+	} ) ;
+
+	loop.exec() ;
+
+	Task::process::run( m,"rm",{ "-r",dir } ).await() ;
+
+	_check( out == std::vector< QByteArray >{ "0","1","2","3" },"processes ran at the same time and their results are in the order they were started" ) ;
+
+	_check( where == QCoreApplication::instance()->thread(),"the continuation ran on the thread that started the processes" ) ;
+
+	auto r = Task::process::run( m,"sh",{ "-c","sleep 5" },100 ).await() ;
+
+	_check( !r.finished(),"a process that did not finish in time was killed" ) ;
+}
+
+static void _test_process_pool()
+{
+	_print( "Testing Task::process::pool" ) ;
+
+	Task::process::pool pool( 2 ) ;
+
+	/*
+	 * Processes of the pool wait for a file to show up in a temporary directory so the
+	 * test decides when they finish.
+	 */
+	auto dir = QString::fromUtf8( Task::process::run( "mktemp",QStringList{ "-d" } ).get().std_out().trimmed() ) ;
+
+	QString gate = "while [ ! -e \"$0/go\" ]; do sleep 0.01; done; printf " ;
+
+	std::vector< Task::future< Task::process::result > * > e ;
+
+	for( int i = 0 ; i < 4 ; i++ ){
+
+		e.emplace_back( &pool.run( "sh",QStringList{ "-c",gate + QString::number( i ),dir } ) ) ;
+	}
+
+	std::vector< Task::process::result > r ;
+
+	QEventLoop loop ;
+
+	Task::when_all( e ).then( [ & ]( std::vector< Task::process::result > x ){
+
+		r = std::move( x ) ;
+
+		loop.exit() ;
+	} ) ;
+
+	auto stats = pool.stats() ;
+
+	_check( stats.running == 2 && stats.queued == 2,"no more than two processes ran at the same time" ) ;
+
+	Task::process::run( "touch",QStringList{ dir + "/go" } ).get() ;
+
+	loop.exec() ;
+
+	_check( r.size() == 4 && r[ 0 ].std_out() == "0" && r[ 3 ].std_out() == "3","results of processes are in the order they were started" ) ;
+
+	stats = pool.stats() ;
+
+	_check( stats.started == 4 && stats.running == 0 && stats.queued == 0,"the pool counted the processes it started" ) ;
+
+	/*
+	 * .get() on the thread of the multiplexer waits for a slot like any other process.
+	 */
+	Task::process::pool one( 1 ) ;
+
+	QByteArray out ;
+
+	bool first = false ;
+
+	bool capped = true ;
+
+	Task::process::run( Task::process::io_thread(),"true",{} ).then( Task::inline_continuation,[ & ]( const Task::process::result& ){
+
+		one.run( "sh",{ "-c","printf a" } ).then( Task::inline_continuation,[ & ]( const Task::process::result& ){
+
+			capped = capped && one.stats().running <= one.max_processes() ;
+
+			first = true ;
+		} ) ;
+
+		capped = capped && one.stats().running <= one.max_processes() ;
+
+		out = one.run( "sh",{ "-c","printf x" } ).get().std_out() ;
+
+		capped = capped && one.stats().running <= one.max_processes() ;
+
+		QMetaObject::invokeMethod( &loop,[ & ](){ loop.exit() ; },Qt::QueuedConnection ) ;
+	} ) ;
+
+	loop.exec() ;
+
+	_check( out == "x" && first,".get() on the thread of the multiplexer waited for the slot of the other process" ) ;
+
+	_check( capped && one.stats().started == 2,".get() on the thread of the multiplexer took a slot of the pool" ) ;
+
+	Task::process::run( "rm",QStringList{ "-rf",dir } ).get() ;
+}
+
+static void _scan( std::atomic< int >& count,QSemaphore& done,QMutex& mutex,std::set< QThread * >& threads,int depth )
+{
+	{
+		QMutexLocker m( &mutex ) ;
+
+		threads.insert( QThread::currentThread() ) ;
+	}
+
+	count++ ;
+
+	if( depth > 0 ){
+
+		for( int i = 0 ; i < 4 ; i++ ){
+
+			Task::exec( [ &,depth ](){ _scan( count,done,mutex,threads,depth - 1 ) ; } ) ;
+		}
+	}
+
+	done.release() ;
+}
+
+static void _test_work_stealing()
+{
+	_print( "Testing Task::scheduler" ) ;
+
+	Task::scheduler s( 2 ) ;
+
+	std::atomic< int > count{ 0 } ;
+
+	QMutex mutex ;
+
+	std::set< QThread * > threads ;
+
+	QSemaphore done ;
+
+	Task::exec( s,[ & ](){ _scan( count,done,mutex,threads,4 ) ; } ) ;
+
+	done.acquire( 341 ) ;
+
+	_check( count.load() == 341,"tasks started from a worker ran" ) ;
+
+	_check( threads.size() <= 2 && threads.count( QThread::currentThread() ) == 0,"tasks started from a worker stayed on the scheduler" ) ;
+
+	int r = Task::run( s,[](){
+
+		return Task::run( [](){ return 3 ; } ).await() + Task::run( [](){ return 4 ; } ).get() ;
+
+	} ).await() ;
+
+	_check( r == 7,"a worker awaited tasks it started" ) ;
+
+	/*
+	 * The continuation is posted to a worker that has nothing else to do and sleeps.
+	 */
+	QThread * worker = nullptr ;
+	QThread * where = nullptr ;
+
+	Task::exec( s,[ & ](){
+
+		worker = QThread::currentThread() ;
+
+		Task::run( Task::backend::thread,[](){ return 1 ; } ).then( [ & ]( int x ){
+
+			r = x ;
+
+			where = QThread::currentThread() ;
+
+			done.release() ;
+		} ) ;
+	} ) ;
+
+	done.acquire() ;
+
+	_check( r == 1 && where == worker,"an event posted to a sleeping worker woke it up" ) ;
+}
+
+static void _test_executors()
+{
+	_print( "Testing Task::executor" ) ;
+
+	Task::inline_executor e ;
+
+	QThread * where = nullptr ;
+
+	int r = Task::run( e,[ & ](){ where = QThread::currentThread() ; return 1 ; } ).await() ;
+
+	_check( r == 1 && where == QThread::currentThread(),"Task::inline_executor ran the task on the current thread" ) ;
+
+	bool called = false ;
+
+	Task::run( e,[](){ return 2 ; } ).then( [ & ]( int x ){ called = x == 2 ; } ) ;
+
+	_check( called,"Task::inline_executor ran the continuation before .then() returned" ) ;
+
+	/*
+	 * A task started from a worker and later run by that same worker is not run inline,
+	 * its continuation still goes to the thread of its context object.
+	 */
+	Task::scheduler one( 1 ) ;
+
+	QThread thread ;
+
+	thread.start() ;
+
+	QObject context ;
+
+	context.moveToThread( &thread ) ;
+
+	QSemaphore s ;
+
+	Task::exec( one,[ & ](){
+
+		Task::run( one,[](){ return 5 ; } ).then( &context,[ & ]( int x ){
+
+			r = x ;
+
+			where = QThread::currentThread() ;
+
+			s.release() ;
+		} ) ;
+	} ) ;
+
+	s.acquire() ;
+
+	_check( r == 5 && where == &thread,"a task run by the worker that started it delivered to its context" ) ;
+
+	thread.quit() ;
+	thread.wait() ;
+
+	Task::thread_pool_executor cpu( 2 ) ;
+
+	r = Task::run( cpu,[ & ](){ where = QThread::currentThread() ; return 3 ; } ).await() ;
+
+	_check( r == 3 && where != QThread::currentThread(),"Task::thread_pool_executor ran the task on its own thread" ) ;
+
+	std::atomic< int > count{ 0 } ;
+
+	Task::run_tasks( cpu,[ & ](){ count++ ; },[ & ](){ count++ ; },[ & ](){ count++ ; } ).await() ;
+
+	_check( count.load() == 3,"Task::run_tasks() ran every task on an executor" ) ;
+
+	Task::elastic_executor io ;
+
+	auto p = Task::process::run( io,"sh",{ "-c","printf abc" } ).await() ;
+
+	_check( p.success() && p.std_out() == "abc","Task::process::run() waited on a process on an executor" ) ;
+}
+
+static void _test_run_tasks_ranges()
+{
+	_print( "Testing Task::run_tasks() with ranges" ) ;
+
+	std::atomic< int > count{ 0 } ;
+
+	std::vector< std::function< void() > > tasks ;
+
+	for( int i = 0 ; i < 50 ; i++ ){
+
+		tasks.emplace_back( [ & ](){ count++ ; } ) ;
+	}
+
+	Task::run_tasks( Task::backend::thread_pool,std::move( tasks ) ).await() ;
+
+	_check( count.load() == 50,"every task of a range ran" ) ;
+
+	std::vector< Task::future< void > * > futures ;
+
+	for( int i = 0 ; i < 10 ; i++ ){
+
+		futures.emplace_back( &Task::run( [ & ](){ count++ ; } ) ) ;
+	}
+
+	Task::run_tasks( futures ).await() ;
+
+	_check( count.load() == 60,"every future of a range ran" ) ;
+
+	std::vector< int > order ;
+
+	bool main_thread = true ;
+
+	std::vector< Task::pair< int > > pairs ;
+
+	for( int i = 0 ; i < 5 ; i++ ){
+
+		pairs.emplace_back( Task::make_pair( [ i ](){ return i ; },[ & ]( int e ){
+
+			order.emplace_back( e ) ;
+
+			main_thread = main_thread && QThread::currentThread() == QCoreApplication::instance()->thread() ;
+		} ) ) ;
+	}
+
+	Task::run( std::move( pairs ) ).get() ;
+
+	_check( order == std::vector< int >{ 0,1,2,3,4 },".get() ran the pairs of a range in order" ) ;
+
+	_check( main_thread,"continuations of pairs ran on the calling thread" ) ;
+
+	Task::run_tasks( std::vector< std::function< void() > >() ).await() ;
+}
+
+static void _test_next()
+{
+	_print( "Testing future::next()" ) ;
+
+	QThread * a = nullptr ;
+	QThread * b = nullptr ;
+
+	auto r = Task::run( [ & ](){ a = QThread::currentThread() ; return 2 ; } ).next( [ & ]( int e ){
+
+		b = QThread::currentThread() ;
+
+		return QString::number( e * 3 ) ;
+
+	} ).next( []( QString e ){
+
+		return e.toStdString().size() ;
+
+	} ).await() ;
+
+	_check( r == 1,"each stage got the result of the previous one" ) ;
+
+	_check( a == b && a != QThread::currentThread(),"stages ran one after another on the worker" ) ;
+
+	std::atomic< int > count{ 0 } ;
+
+	int m = Task::run_tasks( [ & ](){ count++ ; },[ & ](){ count++ ; } ).next( [ & ](){ return count.load() ; } ).await() ;
+
+	_check( m == 2,"a stage after a future of many tasks ran after all of them" ) ;
+
+	_check( Task::run( [](){ return 4 ; } ).next( []( int e ){ return e + 1 ; } ).get() == 5,".get() ran the stages" ) ;
+}
+
+static void _test_strand()
+{
+	_print( "Testing Task::strand" ) ;
+
+	Task::strand s ;
+
+	std::vector< int > order ;
+
+	std::atomic< int > active{ 0 } ;
+
+	bool overlap = false ;
+
+	auto step = [ & ]( int i ){
+
+		return [ &,i ](){
+
+			if( active.fetch_add( 1 ) != 0 ){
+
+				overlap = true ;
+			}
+
+			QThread::yieldCurrentThread() ;
+
+			order.emplace_back( i ) ;
+
+			active.fetch_sub( 1 ) ;
+		} ;
+	} ;
+
+	/*
+	 * The strand is held until every task is queued so that all of them are run back to back.
+	 */
+	QSemaphore gate ;
+
+	Task::exec( s,[ & ](){ gate.acquire() ; } ) ;
+
+	for( int i = 0 ; i < 20 ; i++ ){
+
+		Task::exec( s,step( i ) ) ;
+	}
+
+	gate.release() ;
+
+	Task::run( s,[](){} ).await() ;
+
+	std::vector< int > expected ;
+
+	for( int i = 0 ; i < 20 ; i++ ){
+
+		expected.emplace_back( i ) ;
+	}
+
+	_check( order == expected && !overlap,"tasks on a strand ran one at a time in order" ) ;
+
+	QEventLoop loop ;
+
+	Task::run_tasks( s,step( 20 ),step( 21 ),step( 22 ) ).when_seq( [ & ](){ loop.exit() ; } ) ;
+
+	loop.exec() ;
+
+	_check( order.size() == 23 && order.back() == 22 && !overlap,".when_seq() on a strand ran the tasks in order" ) ;
+
+	int count = Task::run( s,[ & ](){
+
+		std::atomic< int > here{ 0 } ;
+
+		auto task = [ & ](){ here++ ; } ;
+
+		Task::run_tasks( Task::run( s,task ),Task::run( s,task ) ).wait() ;
+
+		return here.load() + ( Task::strand::current() == &s ? 1 : 0 ) ;
+
+	} ).await() ;
+
+	_check( count == 3,"wait() from a task of a strand ran tasks of the same strand" ) ;
+
+	Task::strands keys( 4 ) ;
+
+	auto& a = keys[ QString( "a" ) ] ;
+
+	_check( &a == &keys[ QString( "a" ) ] && &keys[ std::string( "b" ) ] == &keys[ std::string( "b" ) ],"equal keys went to the same strand" ) ;
+
+	auto& c = keys.get( 7,[]( int e ){ return e + 1 ; } ) ;
+
+	_check( &c == &keys.get( 0 ),"a hasher given to .get() picked the strand" ) ;
+}
+
+static void _test_max_in_flight()
+{
+	_print( "Testing future::max_in_flight()" ) ;
+
+	std::atomic< int > active{ 0 } ;
+	std::atomic< int > peak{ 0 } ;
+	std::atomic< int > count{ 0 } ;
+
+	std::vector< std::function< void() > > tasks ;
+
+	for( int i = 0 ; i < 30 ; i++ ){
+
+		tasks.emplace_back( [ & ](){
+
+			auto n = active.fetch_add( 1 ) + 1 ;
+
+			auto p = peak.load() ;
+
+			while( n > p && !peak.compare_exchange_weak( p,n ) ){
+			}
+
+			/*
+			 * Gives other tasks a chance to start while this one counts as active.
+			 */
+			QThread::yieldCurrentThread() ;
+
+			active.fetch_sub( 1 ) ;
+
+			count++ ;
+		} ) ;
+	}
+
+	Task::run_tasks( Task::backend::thread_pool,std::move( tasks ) ).max_in_flight( 3 ).await() ;
+
+	_check( count.load() == 30,"every task ran" ) ;
+
+	_check( peak.load() <= 3,"no more than 3 tasks ran at the same time" ) ;
+}
+
+static void _test_graph()
+{
+	_print( "Testing Task::graph" ) ;
+
+	Task::graph g ;
+
+	QMutex mutex ;
+
+	std::vector< char > order ;
+
+	auto node = [ & ]( char c ){
+
+		return [ &,c ](){
+
+			QMutexLocker m( &mutex ) ;
+
+			order.emplace_back( c ) ;
+		} ;
+	} ;
+
+	auto a = g.add( node( 'a' ) ) ;
+	auto b = g.add( node( 'b' ) ) ;
+	auto c = g.add( node( 'c' ),{ a,b } ) ;
+	auto d = g.add( node( 'd' ),{ a } ) ;
+	auto e = g.add( node( 'e' ) ) ;
+
+	g.add_edge( c,e ) ;
+	g.add_edge( d,e ) ;
+
+	auto r = g.run().await() ;
+
+	auto position = [ & ]( char x ){
+
+		return std::find( order.begin(),order.end(),x ) - order.begin() ;
+	} ;
+
+	_check( order.size() == 5 && order.back() == 'e',"every node ran once and the last node ran last" ) ;
+
+	_check( position( 'c' ) > position( 'a' ) && position( 'c' ) > position( 'b' ) && position( 'd' ) > position( 'a' ),"nodes ran after the nodes they depend on" ) ;
+
+	/*
+	 * Which chain is the longest depends on how long the nodes ran,it is one of them.
+	 */
+	auto chains = std::vector< std::vector< std::size_t > >{ { a.id,c.id,e.id },{ b.id,c.id,e.id },{ a.id,d.id,e.id } } ;
+
+	_check( std::find( chains.begin(),chains.end(),r.critical_nodes ) != chains.end(),"the critical path is a chain of dependent nodes" ) ;
+
+	_check( r.critical_path <= r.elapsed,"the critical path is not longer than the graph" ) ;
+
+	Task::graph k ;
+
+	auto x1 = k.add( node( 'x' ) ) ;
+	auto x2 = k.add( node( 'y' ),{ x1 } ) ;
+	auto x3 = k.add( node( 'z' ),{ x1,x2 } ) ;
+
+	_check( k.run().await().critical_nodes == std::vector< std::size_t >{ x1.id,x2.id,x3.id },"the critical path is the longest chain of dependent nodes" ) ;
+
+	_check( !r.cycle,"the graph has no cycle" ) ;
+
+	Task::graph h ;
+
+	bool ran = false ;
+
+	auto x = h.add( [ & ](){ ran = true ; } ) ;
+	auto y = h.add( [ & ](){ ran = true ; },{ x } ) ;
+
+	h.add_edge( y,x ) ;
+
+	_check( h.run().await().cycle && !ran,"a graph with a cycle did not run" ) ;
+
+	auto empty = Task::graph().run().get() ;
+
+	_check( !empty.cycle && empty.critical_nodes.empty(),".get() on an empty graph returned an empty report" ) ;
+}
+
+/*
+ * An item that can not be default constructed or assigned and counts its instances.
+ */
+struct _item
+{
+	explicit _item( int e ) : value( e )
+	{
+		_item::live()++ ;
+	}
+	_item( _item&& e ) : value( e.value )
+	{
+		_item::live()++ ;
+	}
+	_item& operator=( _item&& ) = delete ;
+	~_item()
+	{
+		_item::live()-- ;
+	}
+	static std::atomic< int >& live()
+	{
+		static std::atomic< int > m{ 0 } ;
+		return m ;
+	}
+	int value ;
+};
+
+static void _test_pipeline()
+{
+	_print( "Testing Task::pipeline" ) ;
+
+	long sum = 0 ;
+
+	int count = 0 ;
+
+	QThread * last = nullptr ;
+
+	bool one_thread = true ;
+
+	Task::pipeline< int >( []( Task::bounded_queue< int >& out ){
+
+		for( int i = 0 ; i < 1000 ; i++ ){
+
+			out.push( i ) ;
+		}
+
+	},8 ).stage( 4,[]( int e ){
+
+		return QString::number( e ) ;
+
+	} ).stage( 1,[ & ]( QString e ){
+
+		if( last && last != QThread::currentThread() ){
+
+			one_thread = false ;
+		}
+
+		last = QThread::currentThread() ;
+
+		sum += std::stol( e.toStdString() ) ;
+
+		count++ ;
+
+	} ).run().await() ;
+
+	_check( count == 1000 && sum == 999L * 1000 / 2,"every item went through every stage" ) ;
+
+	_check( one_thread,"a stage with one worker ran on one thread" ) ;
+
+	QEventLoop loop ;
+
+	Task::pipeline< int >( []( Task::bounded_queue< int >& ){} ).stage( 2,[]( int ){} ).run().then( [ & ](){ loop.exit() ; } ) ;
+
+	loop.exec() ;
+	int total = 0 ;
+
+	Task::pipeline< _item >( []( Task::bounded_queue< _item >& out ){
+
+		for( int i = 0 ; i < 100 ; i++ ){
+
+			out.push( _item( i ) ) ;
+		}
+
+	},4 ).stage( 2,[]( _item e ){
+
+		return _item( e.value * 2 ) ;
+
+	} ).stage( 1,[ & ]( _item e ){
+
+		total += e.value ;
+
+	} ).run().await() ;
+
+	_check( total == 99 * 100 && _item::live() == 0,"a pipeline moved items that can not be default constructed" ) ;
+
+	{
+		Task::bounded_queue< _item > queue( 4 ) ;
+
+		queue.push( _item( 1 ) ) ;
+		queue.push( _item( 2 ) ) ;
+
+		queue.consume( [ & ]( _item&& e ){ total = e.value ; } ) ;
+	}
+
+	_check( total == 1 && _item::live() == 0,"items left in a queue were destroyed with it" ) ;
+}
+
+static void _test_when_any_once()
+{
+	_print( "Testing .when_any() and .when_all() completion" ) ;
+
+	std::atomic< int > count{ 0 } ;
+
+	std::atomic< int > inside{ 0 } ;
+
+	std::atomic< bool > overlap{ false } ;
+
+	std::atomic< int > left{ 4 } ;
+
+	int any = 0 ;
+
+	int all = 0 ;
+
+	QEventLoop loop ;
+
+	auto done = [ & ](){
+
+		if( --left == 0 ){
+
+			QMetaObject::invokeMethod( &loop,[ & ](){ loop.exit() ; },Qt::QueuedConnection ) ;
+		}
+	} ;
+
+	auto continuation = [ & ](){
+
+		if( inside.fetch_add( 1 ) > 0 ){
+
+			overlap = true ;
+		}
+
+		QThread::yieldCurrentThread() ;
+
+		inside-- ;
+
+		done() ;
+	} ;
+
+	auto task = [ & ](){ count++ ; } ;
+
+	Task::run( Task::make_pair( task,continuation ),
+		   Task::make_pair( task,continuation ),
+		   Task::make_pair( task,continuation ) ).when_any( [ & ](){ any++ ; } ) ;
+
+	Task::run_tasks( Task::backend::thread_pool,[ & ](){ count++ ; },[ & ](){ count++ ; } ).when_all( [ & ](){
+
+		all++ ;
+
+		done() ;
+	} ) ;
+
+	loop.exec() ;
+
+	_check( count.load() == 5,"every task ran" ) ;
+
+	_check( any == 1 && all == 1,"the continuations ran once" ) ;
+
+	_check( !overlap.load(),"continuations of pairs did not run at the same time" ) ;
+}
+
+static void _test_statistics()
+{
+	_print( "Testing Task::get_statistics()" ) ;
+
+	for( int i = 0 ; i < 10 ; i++ ){
+
+		Task::run( Task::backend::thread_pool,[](){ return 1 ; } ).await() ;
+	}
+
+	Task::reset_statistics() ;
+
+	int n = 0 ;
+
+	for( int i = 0 ; i < 100 ; i++ ){
+
+		n += Task::run( Task::backend::thread_pool,[](){ return 1 ; } ).await() ;
+	}
+
+	auto s = Task::get_statistics() ;
+
+	_check( n == 100 && s.tasks == 100,"every task was counted" ) ;
+
+	_check( s.allocations < s.tasks,"memory of finished tasks was reused" ) ;
+}
+
+static void _test_move_only_continuations()
+{
+	_print( "Testing move only continuations" ) ;
+
+	int r = 0 ;
+
+	QEventLoop loop ;
+
+	std::unique_ptr< int > p( new int( 5 ) ) ;
+
+	Task::run( [](){ return 2 ; } ).then( [ &,p = std::move( p ) ]( int e ){
+
+		r = e + *p ;
+
+		loop.exit() ;
+	} ) ;
+
+	loop.exec() ;
+
+	_check( r == 7,"a continuation that can only be moved ran" ) ;
+
+	std::array< long,64 > big ;
+
+	big.fill( 1 ) ;
+
+	std::unique_ptr< int > q( new int( 1 ) ) ;
+
+	long sum = Task::run( [ big,q = std::move( q ) ](){
+
+		return std::accumulate( big.begin(),big.end(),0L ) + *q ;
+
+	} ).await() ;
+
+	_check( sum == 65,"a task too big to be stored inline ran" ) ;
+}
+
+static void _test_copyable_callables()
+{
+	auto aa = []( int x ){ return x ; } ;
+
+	auto bb = [](){	return 6 ; } ;
+
+	auto cc = [](){} ;
+
+	auto dd = [](int){} ;
+
+	Task::run( aa,4 ).get() ;
+	Task::run( dd,4 ).get() ;
+
+	Task::run( bb ).get() ;
+	Task::run( cc ).get() ;
+
+	Task::await( bb ) ;
+
+	auto& tt = Task::run( bb ) ;
+
+	Task::await( tt ) ;
+	Task::await( Task::run( cc ) ) ;
+
+	Task::await( aa,4 ) ;
+
+	Task::await( dd,4 ) ;
+
+	Task::await( bb ) ;
+
+	Task::await( cc ) ;
+
+	auto& zz = Task::run( bb ) ;
+
+	Task::await( zz ) ;
+	Task::await( Task::run( cc ) ) ;
+
+	Task::exec( aa,4 ) ;
+	Task::exec( dd,4 ) ;
+
+	Task::exec( bb ) ;
+	Task::exec( cc ) ;
+
+	Task::run_tasks( bb,bb,cc ).get() ;
+
+	Task::run_tasks( Task::run( cc ),Task::run( cc ) ).get() ;
+}
+
+struct foo
+{
+	foo()
+	{
+	}
+	foo(int a)
+	{
+		_print(a);
+	}
+	std::unique_ptr<int> m ;
+};
+
+struct www
+{
+	void operator()()
+	{
+
+	}
+	www( const www& )
+	{
+		_print( "const www&" ) ;
+	}
+	www( www&& )
+	{
+		_print( "www&&" ) ;
+	}
+	www()
+	{
+		_print( "www()" ) ;
+	}
+	www& operator=( const www& )
+	{
+		_print( "www& operator=( const www& )" ) ;
+
+		return *this ;
+	}
+	www& operator=( www&& )
+	{
+		_print( "www& operator=( www&& )" ) ;
+
+		return *this ;
+	}
+
+	std::unique_ptr<int> m ;
+};
+
+void example::run()
+{
+#if __cplusplus >= 201703L
+
+	Task::await([](foo,foo,foo){},foo(7),foo(7),foo(7));
+#endif
+	_test_copyable_callables() ;
+
+	_test_move_only_callables() ;
+
+	_test_thread_pool() ;
+
+	_test_when_all() ;
+
+	_test_wait() ;
+
+	_test_then_with_context() ;
+
+	_test_typed_progress() ;
+
+	_test_coalesced_progress() ;
+
+	_test_process_stream() ;
+
+	_test_parallel_for() ;
+
+	_test_parallel_reduce() ;
+
+	_test_fork_join() ;
+
+	_test_io_thread() ;
+
+	_test_process_pool() ;
+
+	_test_work_stealing() ;
+
+	_test_executors() ;
+
+	_test_run_tasks_ranges() ;
+
+	_test_next() ;
+
+	_test_strand() ;
+
+	_test_max_in_flight() ;
+
+	_test_graph() ;
+
+	_test_pipeline() ;
+
+	_test_when_any_once() ;
+
+	_test_statistics() ;
+
+	_test_move_only_continuations() ;
+
+#if __cplusplus > 201703L
+	_test_coroutines() ;
+#endif
 
 	_test_when_any1() ;
 
@@ -32,15 +32,46 @@
 #define __TASK_H_INCLUDED__
 
 #include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#include <new>
 #include <vector>
+#include <deque>
+#include <queue>
+#include <memory>
+#include <mutex>
 #include <utility>
+#include <tuple>
+#include <algorithm>
+#include <initializer_list>
 #include <future>
 #include <functional>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#if __cplusplus > 201703L
+#include <coroutine>
+#endif
 #include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
 #include <QEventLoop>
+#include <QAbstractEventDispatcher>
+#include <QCoreApplication>
+#include <QEvent>
+#include <QMetaObject>
 #include <QMutex>
+#include <QWaitCondition>
+#include <QSemaphore>
+#include <QTimer>
 #include <QProcess>
+#include <QFile>
 #include <QVariant>
+#include <QHash>
+
+#if QT_VERSION < QT_VERSION_CHECK( 5,10,0 )
+	#error "task.hpp needs Qt 5.10 or later"
+#endif
 /*
  *
  * Examples on how to use the library are at the end of this file.
@@ -109,1225 +140,7632 @@ namespace Task
 	template< typename T >
 	class future;
 
+	/*
+	 * Passed as the first argument to .then() to run the continuation directly on the
+	 * worker thread that finished the task instead of posting it to another thread.
+	 */
+	struct inline_continuation_t
+	{
+	};
+
+	constexpr inline_continuation_t inline_continuation{} ;
+
+	/*
+	 * Selects what powers tasks created by Task::run(),Task::exec() and Task::run_tasks().
+	 *
+	 * thread:      Each task gets its own QThread that is created when the task is created
+	 *              and deleted when the task finishes. This is the default.
+	 *
+	 * thread_pool: Tasks run on long lived threads owned by the QThreadPool returned by
+	 *              Task::thread_pool(). Use Task::thread_pool().setMaxThreadCount() to
+	 *              configure the number of threads. Futures powered by the pool do not
+	 *              have a QThread of their own and .all_threads() reports them as nullptr.
+	 *
+	 * work_stealing: Tasks run on the workers of the scheduler returned by
+	 *                Task::work_stealing_scheduler(). Each worker has its own deque of tasks,
+	 *                tasks created from inside a worker go to that worker's deque and idle
+	 *                workers steal from the others. Tasks created without an explicit backend
+	 *                from a task that is already running on a worker also run on the scheduler.
+	 *                Futures powered by the scheduler report nullptr in .all_threads().
+	 */
+	enum class backend{ thread,thread_pool,work_stealing } ;
+
 	namespace detail
 	{
-		template< typename T >
-		void add_void( Task::future< T >&,Task::future< T >&,std::function< T() >&& ) ;
-		template< typename T >
-		void add( Task::future< T >&,Task::future< T >&,std::function< void( T ) >&& ) ;
+		inline std::atomic< Task::backend >& backend_setting()
+		{
+			static std::atomic< Task::backend > m( Task::backend::thread ) ;
+			return m ;
+		}
 
-		template<typename Function>
-		class functionWrapper
+		struct counters
 		{
-		public:
-			template< typename ... Args >
-			auto operator()( Args&& ... args ) const
-			{
-				return (*m_function)( std::forward<Args>( args ) ... ) ;
-			}
-			functionWrapper( Function function ) :
-				m_function( std::make_shared<Function>( Function( std::move( function ) ) ) )
-			{
-			}
-		private:
-			std::shared_ptr<Function> m_function ;
+			std::atomic< std::uint64_t > tasks{ 0 } ;
+			std::atomic< std::uint64_t > allocations{ 0 } ;
+			std::atomic< std::uint64_t > continuations{ 0 } ;
+			std::atomic< std::uint64_t > continuation_latency{ 0 } ;
+			std::atomic< std::uint64_t > max_continuation_latency{ 0 } ;
 		};
 
-		template<typename Function>
-		functionWrapper<Function> function( Function function )
+		inline Task::detail::counters& statistics()
 		{
-			return functionWrapper<Function>( std::move( function ) ) ;
+			static Task::detail::counters m ;
+			return m ;
 		}
+	}
 
-#if __cplusplus >= 201703L
-		template<typename Function,typename ... Args>
-		using result_of = std::invoke_result_t<Function,Args ...> ;
-#else
-		template<typename Function,typename ... Args>
-		using result_of = std::result_of_t<Function(Args ...)> ;
-#endif
-		template<typename Function>
-		using copyable = std::enable_if_t<std::is_copy_constructible<Function>::value,int> ;
-
-		template<typename Function>
-		using not_copyable = std::enable_if_t<!std::is_copy_constructible<Function>::value,int> ;
-
-		template<typename ReturnType,typename Function,typename ... Args>
-		using has_same_return_type = std::enable_if_t<std::is_same<result_of<Function,Args...>,ReturnType>::value,int> ;
-
-		template<typename Function,typename ... Args>
-		using has_void_return_type = has_same_return_type<void,Function,Args...> ;
-
-		template<typename Function,typename ... Args>
-		using has_bool_return_type = has_same_return_type<bool,Function,Args...> ;
-
-		template<typename Function,typename ... Args>
-		using has_non_void_return_type = std::enable_if_t<!std::is_void<result_of<Function,Args...>>::value,int> ;
-
-		template<typename Function,typename ... Args>
-		using has_argument = has_same_return_type<result_of<Function,Args...>,Function,Args...> ;
-
-		template<typename Function>
-		using has_no_argument = has_same_return_type<result_of<Function>,Function> ;
-
-		template<typename Function,typename ... Args>
-		using returns_void = has_void_return_type<Function,Args...> ;
+	/*
+	 * The backend used when a backend is not explicitly given.
+	 */
+	inline Task::backend default_backend()
+	{
+		return Task::detail::backend_setting().load( std::memory_order_relaxed ) ;
+	}
 
-		template<typename Function,typename ... Args>
-		using returns_value = has_non_void_return_type<Function,Args...> ;
+	inline void set_default_backend( Task::backend e )
+	{
+		Task::detail::backend_setting().store( e,std::memory_order_relaxed ) ;
 	}
 
-	template< typename T >
-	struct pair{
-		pair( std::function< T() > first,std::function< void( T ) > second ) :
-			value( std::make_pair( std::move( first ),std::move( second ) ) )
-		{
-		}
-		std::pair< std::function< T() >,std::function< void( T ) > > value ;
+	/*
+	 * Counters that are useful when measuring the overhead of the library.
+	 */
+	struct statistics
+	{
+		/*
+		 * The number of tasks created by Task::run() and friends.
+		 */
+		std::uint64_t tasks ;
+		/*
+		 * The number of times memory for a task had to come from the heap instead of
+		 * being reused from a task that already finished. Memory Qt allocates for
+		 * QObject internals is not counted.
+		 */
+		std::uint64_t allocations ;
+		/*
+		 * The number of results that were posted to the thread that owns their future.
+		 */
+		std::uint64_t continuations ;
+		/*
+		 * The total and the longest time,in nanoseconds,between a task finishing on its worker
+		 * and its continuation starting on the thread that owns its future.
+		 */
+		std::uint64_t continuation_latency ;
+		std::uint64_t max_continuation_latency ;
 	};
 
-	template<>
-	struct pair<void>{
-		pair( std::function< void() > first,std::function< void() > second ) :
-			value( std::make_pair( std::move( first ),std::move( second ) ) )
-		{
-		}
-		std::pair< std::function< void() >,std::function< void() > > value ;
-	};
-	template< typename E,
-		  typename F,
-		  Task::detail::not_copyable<E> = 0,
-		  Task::detail::not_copyable<F> = 0 >
-	pair<Task::detail::result_of<E>> make_pair( E e,F f )
+	inline Task::statistics get_statistics()
 	{
-		using type = Task::detail::result_of<E> ;
-		return pair<type>( Task::detail::function( std::move( e ) ),Task::detail::function( std::move( f ) ) ) ;
+		auto& m = Task::detail::statistics() ;
+
+		return { m.tasks.load( std::memory_order_relaxed ),
+			 m.allocations.load( std::memory_order_relaxed ),
+			 m.continuations.load( std::memory_order_relaxed ),
+			 m.continuation_latency.load( std::memory_order_relaxed ),
+			 m.max_continuation_latency.load( std::memory_order_relaxed ) } ;
 	}
-	template< typename E,
-		  typename F,
-		  Task::detail::copyable<E> = 0,
-		  Task::detail::copyable<F> = 0 >
-	pair<Task::detail::result_of<E>> make_pair( E e,F f )
+
+	inline void reset_statistics()
 	{
-		return pair<Task::detail::result_of<E>>( std::move( e ),std::move( f ) ) ;
+		auto& m = Task::detail::statistics() ;
+
+		m.tasks.store( 0,std::memory_order_relaxed ) ;
+		m.allocations.store( 0,std::memory_order_relaxed ) ;
+		m.continuations.store( 0,std::memory_order_relaxed ) ;
+		m.continuation_latency.store( 0,std::memory_order_relaxed ) ;
+		m.max_continuation_latency.store( 0,std::memory_order_relaxed ) ;
 	}
-	template< typename E,
-		  typename F,
-		  Task::detail::not_copyable<E> = 0,
-		  Task::detail::copyable<F> = 0 >
-	pair<Task::detail::result_of<E>> make_pair( E e,F f )
+
+	/*
+	 * The pool used by Task::backend::thread_pool.
+	 */
+	inline QThreadPool& thread_pool()
 	{
-		using type = Task::detail::result_of<E> ;
-		return pair<type>( Task::detail::function( std::move( e ) ),std::move( f ) ) ;
+		static QThreadPool m ;
+		return m ;
 	}
-	template< typename E,
-		  typename F,
-		  Task::detail::copyable<E> = 0,
-		  Task::detail::not_copyable<F> = 0 >
-	pair<Task::detail::result_of<E>> make_pair( E e,F f )
+
+	/*
+	 * An executor decides where and when tasks run. Task::run(),Task::exec(),Task::run_tasks()
+	 * and Task::process::run() take an executor as their first argument to run tasks on it
+	 * and an executor must outlive tasks that are started on it.
+	 *
+	 * The interface mirrors QThreadPool::start(),tasks are handed over as QRunnable objects
+	 * and those with autoDelete() set must be deleted by the executor after they run.
+	 */
+	class executor
 	{
-		using type = Task::detail::result_of<E> ;
-		return pair<type>( std::move( e ),Task::detail::function( std::move( f ) ) ) ;
-	}
-	template< typename T >
-	class future : private QObject
+	public:
+		virtual void start( QRunnable * ) = 0 ;
+		virtual ~executor() = default ;
+	};
+
+	/*
+	 * Runs tasks on the thread that starts them,before start() returns.
+	 * Useful in tests.
+	 */
+	class inline_executor : public Task::executor
 	{
 	public:
-		/*
-		 * Use this API if you care about the result
-		 */
-		//std::function< void( T ) >
-		template<typename Function,
-			Task::detail::has_argument<Function,T> = 0,
-			Task::detail::copyable<Function> = 0>
-		void then( Function function )
-		{
-			m_function = std::move( function ) ;
-			this->start() ;
-		}
-		template<typename Function,
-			Task::detail::has_argument<Function,T> = 0,
-			Task::detail::not_copyable<Function> = 0>
-		void then( Function function )
+		void start( QRunnable * e ) override
 		{
-			m_function = Task::detail::function( std::move( function ) ) ;
-			this->start() ;
+			auto autoDelete = e->autoDelete() ;
+
+			auto previous = inline_executor::running() ;
+
+			inline_executor::running() = e ;
+
+			e->run() ;
+
+			inline_executor::running() = previous ;
+
+			if( autoDelete ){
+
+				delete e ;
+			}
 		}
 		/*
-		 * Use this API if you DO NOT care about the result
+		 * The task that an inline executor runs on the current thread,tasks use it to
+		 * tell that they run from inside start().
 		 */
-		//std::function< void( void ) >
-		template<typename Function,
-			Task::detail::has_no_argument<Function> = 0,
-			Task::detail::copyable<Function> = 0>
-		void then( Function function )
-		{
-			m_function_1 = std::move( function ) ;
-			this->start() ;
-		}
-		template<typename Function,
-			Task::detail::has_no_argument<Function> = 0,
-			Task::detail::not_copyable<Function> = 0>
-		void then( Function function )
+		static QRunnable *& running()
 		{
-			m_function_1 = Task::detail::function( std::move( function ) ) ;
-			this->start() ;
+			thread_local QRunnable * m = nullptr ;
+			return m ;
 		}
-		template<typename Function,
-			 Task::detail::has_no_argument<Function> = 0,
-			 Task::detail::not_copyable<Function> = 0>
-		void queue( Function function )
+	};
+
+	/*
+	 * Runs each task on its own QThread,the same way Task::backend::thread does.
+	 */
+	class thread_executor : public Task::executor
+	{
+	public:
+		void start( QRunnable * e ) override
 		{
-			if( this->manages_multiple_futures() ){
+			class thread : public QThread
+			{
+			public:
+				thread( QRunnable * e ) : m_runnable( e )
+				{
+				}
+			private:
+				void run()
+				{
+					auto autoDelete = m_runnable->autoDelete() ;
 
-				m_function_1 = Task::detail::function( std::move( function ) ) ;
+					m_runnable->run() ;
 
-				this->_queue() ;
-			}else{
-				this->then( Task::detail::function( std::move( function ) ) ) ;
-			}
-		}
-		template<typename Function,
-			 Task::detail::has_no_argument<Function> = 0,
-			 Task::detail::copyable<Function> = 0>
-		void queue( Function function )
-		{
-			if( this->manages_multiple_futures() ){
+					if( autoDelete ){
 
-				m_function_1 = std::move( function ) ;
+						delete m_runnable ;
+					}
+				}
+				QRunnable * m_runnable ;
+			} ;
 
-				this->_queue() ;
-			}else{
-				this->then( std::move( function ) ) ;
-			}
+			auto s = new thread( e ) ;
+
+			QObject::connect( s,&QThread::finished,s,&QThread::deleteLater ) ;
+
+			s->start() ;
 		}
+	};
 
-		void queue()
+	/*
+	 * Runs tasks on a QThreadPool of its own that has at most "max_threads" threads.
+	 * QThread::idealThreadCount() threads are used if "max_threads" is less than 1.
+	 * Suitable for CPU bound tasks.
+	 */
+	class thread_pool_executor : public Task::executor
+	{
+	public:
+		thread_pool_executor( int max_threads = 0 )
 		{
-			if( this->manages_multiple_futures() ){
-
-				m_function_1 = [](){} ;
+			if( max_threads > 0 ){
 
-				this->_queue() ;
-			}else{
-				this->then( [](){} ) ;
+				m_pool.setMaxThreadCount( max_threads ) ;
 			}
 		}
-		/*
-		 * Below two API just exposes existing functionality using more standard names
-		 */
-		template<typename Function>
-		void when_all( Function function )
+		void start( QRunnable * e ) override
 		{
-			this->then( std::move( function ) ) ;
+			m_pool.start( e ) ;
 		}
-		template<typename Function>
-		void when_seq( Function function )
+		QThreadPool& pool()
 		{
-			this->queue( std::move( function ) ) ;
+			return m_pool ;
 		}
-		template<typename Function,
-			 Task::detail::has_no_argument<Function> = 0,
-			 Task::detail::copyable<Function> = 0>
-		void when_any( Function function )
-		{
-			if( this->manages_multiple_futures() ){
+	private:
+		QThreadPool m_pool ;
+	};
 
-				this->_when_any( std::move( function ) ) ;
-			}else{
-				this->then( std::move( function ) ) ;
-			}
-		}
-		template<typename Function,
-			 Task::detail::has_no_argument<Function> = 0,
-			 Task::detail::not_copyable<Function> = 0>
-		void when_any( Function function )
+	/*
+	 * A thread pool that adds a thread whenever a task is started and all existing threads
+	 * are busy,up to "max_threads",and lets threads go after they have been idle for
+	 * "expiry_timeout" milliseconds. Suitable for tasks that spend most of their time blocked.
+	 */
+	class elastic_executor : public Task::thread_pool_executor
+	{
+	public:
+		elastic_executor( int max_threads = 256,int expiry_timeout = 30000 ) :
+			Task::thread_pool_executor( max_threads )
 		{
-			if( this->manages_multiple_futures() ){
-
-				this->_when_any( Task::detail::function( std::move( function ) ) ) ;
-			}else{
-				this->then( Task::detail::function( std::move( function ) ) ) ;
-			}
+			this->pool().setExpiryTimeout( expiry_timeout ) ;
 		}
-		void when_all()
+	};
+
+	/*
+	 * Runs tasks one at a time and in the order they were started on a worker of another
+	 * executor,Task::thread_pool() by default. Tasks that are started while the strand is
+	 * busy are run by the same worker right after the current one finishes and a worker is
+	 * only asked for when the strand was idle.
+	 *
+	 * A task of a strand that awaits another task it started on the same strand never
+	 * finishes because the other task is queued behind it. .get() and .wait() run such
+	 * tasks on the calling thread instead.
+	 */
+	class strand : public Task::executor
+	{
+	public:
+		strand() : m_drainer( *this )
 		{
-			this->then( [](){} ) ;
 		}
-		void when_seq()
+		strand( Task::executor& e ) : m_executor( &e ),m_drainer( *this )
 		{
-			this->queue( [](){} ) ;
 		}
-		void when_any()
+		strand( const strand& ) = delete ;
+		strand& operator=( const strand& ) = delete ;
+		/*
+		 * Waits for the worker that runs the last task to let go of the strand.
+		 */
+		~strand()
 		{
-			if( this->manages_multiple_futures() ){
+			QMutexLocker m( &m_mutex ) ;
 
-				this->_when_any( [](){} ) ;
-			}else{
-				this->then( [](){} ) ;
+			while( m_running ){
+
+				m_idle.wait( &m_mutex ) ;
 			}
 		}
-		T get()
+		void start( QRunnable * e ) override
 		{
-			if( this->manages_multiple_futures() ){
-
-				for( auto& it : m_tasks ){
+			m_mutex.lock() ;
 
-					it.second( it.first->get() ) ;
-				}
-
-				this->deleteLater() ;
+			m_queue.push_back( e ) ;
 
-				return T() ;
-			}else{
-				return m_get() ;
-			}
-		}
-		T await()
-		{
-			QEventLoop p ;
+			auto idle = !m_running ;
 
-			T q ;
+			m_running = true ;
 
-			m_function = [ & ]( T&& r ){ q = std::move( r ) ; p.exit() ; } ;
+			m_mutex.unlock() ;
 
-			this->start() ;
+			if( idle ){
 
-			p.exec() ;
+				if( m_executor ){
 
-			return q ;
+					m_executor->start( &m_drainer ) ;
+				}else{
+					Task::thread_pool().start( &m_drainer ) ;
+				}
+			}
 		}
-		bool manages_multiple_futures()
+		/*
+		 * Returns the strand whose task is running on the current thread or nullptr.
+		 */
+		static strand * current()
 		{
-			return m_tasks.size() > 0 ;
+			return strand::running() ;
 		}
-		const std::vector< QThread * >& all_threads()
+	private:
+		static strand *& running()
 		{
-			return m_threads ;
+			thread_local strand * m = nullptr ;
+			return m ;
 		}
-		QThread * first_thread()
-		{
-			return m_threads[ 0 ] ;
-		}
-		QThread * thread_at( std::vector< QThread * >::size_type s )
-		{
-			return m_threads[ s ] ;
-		}
-		void start()
+		class drainer : public QRunnable
 		{
-			if( this->manages_multiple_futures() ){
-
-				this->_start() ;
-			}else{
-				m_start() ;
+		public:
+			drainer( strand& s ) : m_strand( s )
+			{
+				this->setAutoDelete( false ) ;
 			}
-		}
-		void cancel()
-		{
-			if( this->manages_multiple_futures() ){
-
-				for( auto& it : m_tasks ){
-
-					it.first->cancel() ;
-				}
-
-				this->deleteLater() ;
-			}else{
-				m_cancel() ;
+			void run() override
+			{
+				m_strand.drain() ;
 			}
-		}
-		future() = default ;
-		future( const future& ) = delete ;
-		future( future&& ) = delete ;
-		future& operator=( const future& ) = delete ;
-		future& operator=( future&& ) = delete ;
-
-		future( QThread * e,
-			std::function< void() >&& start,
-			std::function< void() >&& cancel,
-			std::function< T() >&& get ) :
-			m_thread( e ),
-			m_start ( std::move( start ) ),
-			m_cancel( std::move( cancel ) ),
-			m_get   ( std::move( get ) )
+		private:
+			strand& m_strand ;
+		};
+		void drain()
 		{
-			if( m_thread ){
+			auto previous = strand::running() ;
 
-				m_threads.push_back( m_thread ) ;
-			}else{
-				/*
-				 * This object was created by "_private_future< T >()" class.
-				 * It has no QThread of its own because it only manages other futures.
-				 *
-				 */
-			}
-		}
-		void run( T&& r )
-		{
-			if( m_function_1 != nullptr ){
+			strand::running() = this ;
 
-				m_function_1() ;
+			while( true ){
 
-			}else if( m_function != nullptr ){
+				m_mutex.lock() ;
 
-				m_function( std::move( r ) ) ;
-			}
-		}
+				if( m_queue.empty() ){
 
-		template< typename E >
-		friend void Task::detail::add( Task::future< E >&,
-					  Task::future< E >&,
-					  std::function< void( E ) >&& ) ;
-	private:
-		void _when_any( std::function< void() > function )
-		{
-			m_when_any_function = std::move( function ) ;
+					strand::running() = previous ;
 
-			for( auto& it : m_tasks ){
+					m_running = false ;
 
-				it.first->then( [ & ]( T&& e ){
+					m_idle.wakeAll() ;
 
-					QMutexLocker m( &m_mutex ) ;
+					m_mutex.unlock() ;
 
-					m_counter++ ;
+					return ;
+				}
 
-					if( m_task_not_run ){
+				auto e = m_queue.front() ;
 
-						m_task_not_run = false ;
+				m_queue.pop_front() ;
 
-						m.unlock() ;
+				m_mutex.unlock() ;
 
-						it.second( std::forward<T>( e ) ) ;
+				auto autoDelete = e->autoDelete() ;
 
-						m_when_any_function() ;
-					}else{
-						m.unlock() ;
-						it.second( std::forward<T>( e ) ) ;
-					}
+				e->run() ;
 
-					if( m_counter == m_tasks.size() ){
+				if( autoDelete ){
 
-						this->deleteLater() ;
-					}
-				} ) ;
+					delete e ;
+				}
 			}
 		}
-		void _queue()
+		Task::executor * m_executor = nullptr ;
+		drainer m_drainer ;
+		QMutex m_mutex ;
+		QWaitCondition m_idle ;
+		std::deque< QRunnable * > m_queue ;
+		bool m_running = false ;
+	};
+
+	namespace detail
+	{
+		/*
+		 * Hashes keys with qHash() when Qt has one for them and with std::hash otherwise.
+		 */
+		class key_hash
 		{
-			m_tasks[ m_counter ].first->then( [ this ]( T&& e ){
+		public:
+			template< typename Key >
+			std::size_t operator()( const Key& key ) const
+			{
+				return key_hash::hash( key,0 ) ;
+			}
+		private:
+			template< typename Key >
+			static auto hash( const Key& key,int ) -> decltype( static_cast< std::size_t >( qHash( key ) ) )
+			{
+				return static_cast< std::size_t >( qHash( key ) ) ;
+			}
+			template< typename Key >
+			static std::size_t hash( const Key& key,long )
+			{
+				return std::hash< Key >()( key ) ;
+			}
+		};
+	}
 
-				m_tasks[ m_counter ].second( std::forward<T>( e ) ) ;
+	/*
+	 * A fixed number of strands where tasks with the same key always go to the same strand.
+	 * Tasks with different keys usually run in parallel but keys that hash to the same strand
+	 * share it. 4 * QThread::idealThreadCount() strands are used if "count" is less than 1.
+	 *
+	 * Keys are hashed with qHash() or std::hash,a hasher can be given to .get() for other keys.
+	 */
+	class strands
+	{
+	public:
+		strands( int count = 0 )
+		{
+			this->init( count,nullptr ) ;
+		}
+		strands( Task::executor& e,int count = 0 )
+		{
+			this->init( count,&e ) ;
+		}
+		template< typename Key,typename Hash = Task::detail::key_hash >
+		Task::strand& get( const Key& key,Hash hash = Hash() )
+		{
+			return *m_strands[ static_cast< std::size_t >( hash( key ) ) % m_strands.size() ] ;
+		}
+		template< typename Key >
+		Task::strand& operator[]( const Key& key )
+		{
+			return this->get( key ) ;
+		}
+	private:
+		void init( int count,Task::executor * e )
+		{
+			if( count < 1 ){
 
-				m_counter++ ;
+				count = 4 * QThread::idealThreadCount() ;
+			}
 
-				if( m_counter == m_tasks.size() ){
+			for( int i = 0 ; i < ( count < 1 ? 1 : count ) ; i++ ){
 
-					m_function_1() ;
+				if( e ){
 
-					this->deleteLater() ;
+					m_strands.emplace_back( new Task::strand( *e ) ) ;
 				}else{
-					this->_queue() ;
+					m_strands.emplace_back( new Task::strand() ) ;
 				}
-			} ) ;
+			}
 		}
-		void _start()
+		std::vector< std::unique_ptr< Task::strand > > m_strands ;
+	};
+
+	/*
+	 * A fixed set of worker threads where each worker owns a deque of tasks.
+	 *
+	 * A worker takes tasks from the back of its own deque,then from the queue of tasks
+	 * that were started from threads that are not workers and then steals from the front
+	 * of the deques of other workers. Tasks started from a worker are pushed to the back
+	 * of its own deque and recursive work therefore stays on the worker that created it
+	 * until another worker becomes idle and steals it.
+	 */
+	class scheduler : public Task::executor
+	{
+	public:
+		/*
+		 * QThread::idealThreadCount() workers are used if "workers" is less than 1.
+		 */
+		scheduler( int workers = 0 )
+		{
+			this->set_worker_count( workers ) ;
+		}
+		scheduler( const scheduler& ) = delete ;
+		scheduler& operator=( const scheduler& ) = delete ;
+		~scheduler()
 		{
-			for( auto& it : m_tasks ){
+			m_stop.store( true ) ;
 
-				it.first->then( [ & ]( T&& e ){
+			this->wake( true ) ;
 
-					QMutexLocker m( &m_mutex ) ;
+			for( auto& it : m_workers ){
 
-					Q_UNUSED( m ) ;
+				it->wait() ;
+			}
+		}
+		/*
+		 * Has no effect once the first task was started.
+		 */
+		void set_worker_count( int workers )
+		{
+			if( m_started.load() ){
 
-					m_counter++ ;
+				return ;
+			}
+
+			if( workers < 1 ){
 
-					it.second( std::forward<T>( e ) ) ;
+				workers = QThread::idealThreadCount() ;
+			}
 
-					if( m_counter == m_tasks.size() ){
+			m_worker_count = workers < 1 ? 1 : workers ;
+		}
+		int worker_count() const
+		{
+			return m_worker_count ;
+		}
+		void start( QRunnable * e ) override
+		{
+			std::call_once( m_init,[ this ](){ this->init() ; } ) ;
 
-						if( m_function_1 != nullptr ){
+			m_pending.fetch_add( 1 ) ;
 
-							m_function_1() ;
+			auto w = scheduler::current_worker() ;
 
-						}else if( m_function != nullptr ){
+			if( w && &w->m_scheduler == this ){
 
-							m_function( T() ) ;
-						}
+				w->push( e ) ;
+			}else{
+				QMutexLocker m( &m_queue_mutex ) ;
 
-						this->deleteLater() ;
-					}
-				} ) ;
+				m_queue.push_back( e ) ;
 			}
-		}
-
-		QThread * m_thread = nullptr ;
-		std::function< void( T ) > m_function = nullptr ;
-		std::function< void() > m_function_1  = nullptr ;
-		std::function< void() > m_start       = [](){} ;
-		std::function< void() > m_cancel      = [](){} ;
-		std::function< T() > m_get            = [](){ return T() ; } ;
-		std::function< void() > m_when_any_function ;
 
-		QMutex m_mutex ;
-		std::vector< std::pair< Task::future< T > *,std::function< void( T ) > > > m_tasks ;
-		std::vector< QThread * > m_threads ;
-		decltype( m_tasks.size() ) m_counter = 0 ;
-		bool m_task_not_run = true ;
-	};
+			if( m_sleepers.load() > 0 ){
 
-	template<>
-	class future< void > : private QObject
-	{
-	public:
-		template<typename Function,Task::detail::copyable<Function> = 0>
-		void then( Function function )
-		{
-			m_function = std::move( function ) ;
-			this->start() ;
+				this->wake( false ) ;
+			}
 		}
-		template<typename Function,Task::detail::not_copyable<Function> = 0>
-		void then( Function function )
+		/*
+		 * Returns the scheduler whose worker is running the current thread or nullptr.
+		 */
+		static scheduler * current()
 		{
-			m_function = Task::detail::function( std::move( function ) ) ;
-			this->start() ;
+			auto w = scheduler::current_worker() ;
+
+			return w ? std::addressof( w->m_scheduler ) : nullptr ;
 		}
-		template<typename Function,Task::detail::copyable<Function> = 0>
-		void queue( Function function )
+		/*
+		 * Runs one pending task on the current thread and returns false if there was none.
+		 * A worker takes it the same way it takes its next task,other threads take it from
+		 * the queue or steal it from a worker.
+		 */
+		bool run_pending()
 		{
-			if( this->manages_multiple_futures() ){
+			std::call_once( m_init,[ this ](){ this->init() ; } ) ;
 
-				m_function = std::move( function ) ;
+			auto w = scheduler::current_worker() ;
 
-				this->_queue() ;
+			auto e = this->next( w && &w->m_scheduler == this ? w : nullptr ) ;
+
+			if( e ){
+
+				this->run( e ) ;
+
+				return true ;
 			}else{
-				this->then( std::move( function ) ) ;
+				return false ;
 			}
 		}
-		template<typename Function,Task::detail::not_copyable<Function> = 0>
-		void queue( Function function )
+	private:
+		class worker : public QThread
 		{
-			if( this->manages_multiple_futures() ){
+		public:
+			worker( scheduler& s,int index ) : m_scheduler( s ),m_index( index )
+			{
+			}
+			void push( QRunnable * e )
+			{
+				QMutexLocker m( &m_mutex ) ;
+				m_deque.push_back( e ) ;
+			}
+			QRunnable * pop()
+			{
+				QMutexLocker m( &m_mutex ) ;
 
-				m_function = Task::detail::function( std::move( function ) ) ;
+				if( m_deque.empty() ){
 
-				this->_queue() ;
-			}else{
-				this->then( Task::detail::function( std::move( function ) ) ) ;
+					return nullptr ;
+				}else{
+					auto e = m_deque.back() ;
+					m_deque.pop_back() ;
+					return e ;
+				}
 			}
-		}
-		void queue()
-		{
-			if( this->manages_multiple_futures() ){
+			QRunnable * steal()
+			{
+				QMutexLocker m( &m_mutex ) ;
 
-				m_function = [](){} ;
+				if( m_deque.empty() ){
 
-				this->_queue() ;
-			}else{
-				this->then( [](){} ) ;
+					return nullptr ;
+				}else{
+					auto e = m_deque.front() ;
+					m_deque.pop_front() ;
+					return e ;
+				}
+			}
+			scheduler& m_scheduler ;
+			int m_index ;
+			std::atomic< bool > m_sleeping{ false } ;
+		private:
+			void run()
+			{
+				scheduler::current_worker() = this ;
+				m_scheduler.work( *this ) ;
+				scheduler::current_worker() = nullptr ;
 			}
+			QMutex m_mutex ;
+			std::deque< QRunnable * > m_deque ;
+		};
+		static worker *& current_worker()
+		{
+			thread_local worker * m = nullptr ;
+			return m ;
 		}
-		void when_any()
+		void init()
 		{
-			if( this->manages_multiple_futures() ){
+			m_started.store( true ) ;
 
-				this->_when_any( [](){} ) ;
-			}else{
-				this->then( [](){} ) ;
+			for( int i = 0 ; i < m_worker_count ; i++ ){
+
+				m_workers.emplace_back( new worker( *this,i ) ) ;
 			}
-		}
-		template<typename Function,Task::detail::copyable<Function> = 0>
-		void when_any( Function function )
-		{
-			if( this->manages_multiple_futures() ){
+			for( auto& it : m_workers ){
 
-				this->_when_any( std::move( function ) ) ;
-			}else{
-				this->then( std::move( function ) ) ;
+				it->start() ;
 			}
 		}
-		template<typename Function,Task::detail::not_copyable<Function> = 0>
-		void when_any( Function function )
+		/*
+		 * "w" is nullptr when the current thread is not a worker of this scheduler.
+		 */
+		QRunnable * next( worker * w )
 		{
-			if( this->manages_multiple_futures() ){
+			auto e = w ? w->pop() : nullptr ;
 
-				this->_when_any( Task::detail::function( std::move( function ) ) ) ;
-			}else{
-				this->then( Task::detail::function( std::move( function ) ) ) ;
+			if( e ){
+
+				return e ;
+			}
+
+			m_queue_mutex.lock() ;
+
+			if( !m_queue.empty() ){
+
+				e = m_queue.front() ;
+				m_queue.pop_front() ;
+			}
+
+			m_queue_mutex.unlock() ;
+
+			if( e ){
+
+				return e ;
+			}
+
+			auto s = m_workers.size() ;
+
+			auto index = w ? static_cast< decltype( s ) >( w->m_index ) : 0 ;
+
+			for( decltype( s ) i = w ? 1 : 0 ; i < s ; i++ ){
+
+				e = m_workers[ ( index + i ) % s ]->steal() ;
+
+				if( e ){
+
+					return e ;
+				}
 			}
+
+			return nullptr ;
 		}
 		/*
-		 * Below two API just exposes existing functionality using more standard names
+		 * Wakes up one sleeping worker or all of them,the worker that is woken up is
+		 * claimed so that concurrent calls wake up different workers.
 		 */
-		template<typename Function>
-		void when_all( Function function )
+		void wake( bool all )
 		{
-			this->then( std::move( function ) ) ;
+			for( auto& it : m_workers ){
+
+				if( it->m_sleeping.exchange( false ) ){
+
+					it->eventDispatcher()->wakeUp() ;
+
+					if( !all ){
+
+						return ;
+					}
+				}
+			}
 		}
-		template<typename Function>
-		void when_seq( Function function )
+		void run( QRunnable * e )
 		{
-			this->queue( std::move( function ) ) ;
+			m_pending.fetch_sub( 1 ) ;
+
+			auto autoDelete = e->autoDelete() ;
+
+			e->run() ;
+
+			if( autoDelete ){
+
+				delete e ;
+			}
 		}
-		void when_all()
+		static void process_posted_events()
 		{
-			this->then( [](){} ) ;
+			/*
+			 * Workers do not run an event loop and objects created on them,like futures
+			 * of nested tasks,rely on posted events to finish.
+			 */
+			QCoreApplication::sendPostedEvents() ;
+			QCoreApplication::sendPostedEvents( nullptr,QEvent::DeferredDelete ) ;
 		}
-		void when_seq()
+		void work( worker& w )
 		{
-			this->queue() ;
-		}
-		void get()
-		{
-			if( this->manages_multiple_futures() ){
+			while( true ){
 
-				for( auto& it : m_tasks ){
+				auto e = this->next( &w ) ;
 
-					it.first->get() ;
-					it.second() ;
-				}
+				if( e ){
 
-				this->deleteLater() ;
-			}else{
-				m_get() ;
-			}
-		}
-		void await()
-		{
-			QEventLoop p ;
+					this->run( e ) ;
 
-			m_function = [ & ](){ p.exit() ; } ;
+					scheduler::process_posted_events() ;
+				}else{
+					scheduler::process_posted_events() ;
 
-			this->start() ;
+					if( m_stop.load() ){
 
-			p.exec() ;
+						break ;
+					}
+
+					w.m_sleeping.store( true ) ;
+
+					m_sleepers.fetch_add( 1 ) ;
+
+					if( m_pending.load() < 1 && !m_stop.load() ){
+
+						/*
+						 * The worker sleeps in the event dispatcher of its thread,an
+						 * event posted to it or a call to wake() wakes it up and a
+						 * wake up that comes before it sleeps is not lost.
+						 */
+						w.eventDispatcher()->processEvents( QEventLoop::WaitForMoreEvents ) ;
+					}
+
+					w.m_sleeping.store( false ) ;
+
+					m_sleepers.fetch_sub( 1 ) ;
+				}
+			}
 		}
-		bool manages_multiple_futures()
+		int m_worker_count ;
+		std::atomic< bool > m_stop{ false } ;
+		std::once_flag m_init ;
+		std::atomic< bool > m_started{ false } ;
+		std::atomic< int > m_pending{ 0 } ;
+		std::atomic< int > m_sleepers{ 0 } ;
+		QMutex m_queue_mutex ;
+		std::deque< QRunnable * > m_queue ;
+		std::vector< std::unique_ptr< worker > > m_workers ;
+	};
+
+	/*
+	 * The scheduler used by Task::backend::work_stealing.
+	 */
+	inline Task::scheduler& work_stealing_scheduler()
+	{
+		static Task::scheduler m ;
+		return m ;
+	}
+
+	namespace detail
+	{
+		/*
+		 * Set while a task of Task::thread_pool() runs on the current thread.
+		 */
+		inline bool& on_thread_pool()
 		{
-			return m_tasks.size() > 0 ;
+			thread_local bool m = false ;
+			return m ;
 		}
-		const std::vector< QThread * >& all_threads()
+		/*
+		 * True on threads whose pool could have to run tasks the current thread waits for,
+		 * a blocked thread of Task::thread_pool(),of a scheduler or of a strand leaves them
+		 * queued behind it when the pool has no other thread left.
+		 */
+		inline bool on_bounded_pool()
 		{
-			return m_threads ;
+			return Task::detail::on_thread_pool() || Task::scheduler::current() || Task::strand::current() ;
 		}
-		QThread * first_thread()
+		/*
+		 * Marks the current thread while a task of the given pool runs on it.
+		 */
+		template< typename Pool >
+		class pool_thread
 		{
-			return m_threads[ 0 ] ;
-		}
-		QThread * thread_at( std::vector< QThread * >::size_type s )
+		public:
+			pool_thread()
+			{
+			}
+		};
+		template<>
+		class pool_thread< QThreadPool >
 		{
-			return m_threads[ s ] ;
-		}
-		void start()
+		public:
+			pool_thread()
+			{
+				Task::detail::on_thread_pool() = true ;
+			}
+			~pool_thread()
+			{
+				Task::detail::on_thread_pool() = false ;
+			}
+		};
+		/*
+		 * Memory for objects that power futures comes from per thread free lists of blocks
+		 * whose sizes are multiples of 64 bytes. A finished task returns its memory to the
+		 * free list of the thread that deletes it,usually the thread that created it,and
+		 * the next task created on that thread reuses it.
+		 */
+		class recycler
 		{
-			if( this->manages_multiple_futures() ){
+		public:
+			static void * allocate( std::size_t s )
+			{
+				auto& m = Task::detail::statistics() ;
 
-				this->_start() ;
-			}else{
-				m_start() ;
+				m.tasks.fetch_add( 1,std::memory_order_relaxed ) ;
+
+				auto index = recycler::index( s ) ;
+
+				if( index < recycler::size_classes && recycler::alive() ){
+
+					auto& list = recycler::lists().m_lists[ index ] ;
+
+					if( list.head ){
+
+						auto e = list.head ;
+						list.head = e->next ;
+						list.size-- ;
+
+						return e ;
+					}
+
+					m.allocations.fetch_add( 1,std::memory_order_relaxed ) ;
+
+					return ::operator new( index * recycler::block_size ) ;
+				}else{
+					m.allocations.fetch_add( 1,std::memory_order_relaxed ) ;
+
+					return ::operator new( s ) ;
+				}
 			}
-		}
-		void cancel()
-		{
-			if( this->manages_multiple_futures() ){
+			static void deallocate( void * e,std::size_t s )
+			{
+				auto index = recycler::index( s ) ;
 
-				for( auto& it : m_tasks ){
+				if( index < recycler::size_classes && recycler::alive() ){
 
-					it.first->cancel() ;
+					auto& list = recycler::lists().m_lists[ index ] ;
+
+					if( list.size < recycler::max_cached ){
+
+						auto n = static_cast< node * >( e ) ;
+						n->next = list.head ;
+						list.head = n ;
+						list.size++ ;
+
+						return ;
+					}
 				}
 
-				this->deleteLater() ;
-			}else{
-				m_cancel() ;
+				::operator delete( e ) ;
 			}
-		}
-		future() = default ;
-		future( const future& ) = delete ;
-		future( future&& ) = delete ;
-		future& operator=( const future& ) = delete ;
-		future& operator=( future&& ) = delete ;
+		private:
+			static const std::size_t block_size = 64 ;
+			static const std::size_t size_classes = 17 ;
+			static const std::size_t max_cached = 256 ;
 
-		future(	QThread * e ,
-			std::function< void() >&& start,
-			std::function< void() >&& cancel,
-			std::function< void() >&& get ) :
-			m_thread( e ),
-			m_start ( std::move( start ) ),
-			m_cancel( std::move( cancel ) ),
-			m_get   ( std::move( get ) )
-		{
-			if( m_thread ){
+			static std::size_t index( std::size_t s )
+			{
+				return ( s + recycler::block_size - 1 ) / recycler::block_size ;
+			}
+			struct node
+			{
+				node * next ;
+			};
+			struct free_list
+			{
+				node * head = nullptr ;
+				std::size_t size = 0 ;
+			};
+			struct free_lists
+			{
+				free_lists()
+				{
+					recycler::alive() = true ;
+				}
+				~free_lists()
+				{
+					recycler::alive() = false ;
 
-				m_threads.push_back( m_thread ) ;
-			}else{
+					for( auto& it : m_lists ){
+
+						while( it.head ){
+
+							auto e = it.head ;
+							it.head = it.head->next ;
+							::operator delete( e ) ;
+						}
+					}
+				}
+				free_list m_lists[ recycler::size_classes ] ;
+			};
+			static bool& alive()
+			{
 				/*
-				 * This object was created by "_private_future< T >()" class.
-				 * It has no QThread of its own because it only manages other futures.
-				 *
+				 * Tasks can be deleted while a thread is exiting and after its free
+				 * lists are gone.
 				 */
+				thread_local bool m = true ;
+				return m ;
 			}
-		}
+			static free_lists& lists()
+			{
+				thread_local free_lists m ;
+				return m ;
+			}
+		};
 
-		template< typename T >
-		friend void Task::detail::add_void( Task::future< T >&,
-						    Task::future< T >&,
-						    std::function< T() >&& ) ;
-		void run()
+		class recyclable
 		{
-			m_function() ;
-		}
-	private:
-		void _when_any( std::function< void() > function )
+		public:
+			static void * operator new( std::size_t s )
+			{
+				return Task::detail::recycler::allocate( s ) ;
+			}
+			static void operator delete( void * e,std::size_t s )
+			{
+				Task::detail::recycler::deallocate( e,s ) ;
+			}
+		};
+
+		/*
+		 * A pointer to a QObject that can be used from any thread. It stops pointing to the
+		 * object when the object is deleted and calls posted to the object are dropped if it
+		 * was deleted before,or by Qt if it is deleted after,they were posted.
+		 *
+		 * The object has to be alive when the guard is created.
+		 */
+		class object_guard
 		{
-			m_when_any_function = std::move( function ) ;
+		public:
+			object_guard() = default ;
+			object_guard( QObject * object ) : m_state( std::make_shared< state >( object ) )
+			{
+				std::weak_ptr< state > e = m_state ;
 
-			for( auto& it : m_tasks ){
+				m_state->connection = QObject::connect( object,&QObject::destroyed,[ e ](){
 
-				it.first->then( [ & ](){
+					auto s = e.lock() ;
 
-					QMutexLocker m( &m_mutex ) ;
+					if( s ){
+
+						QMutexLocker m( &s->mutex ) ;
 
-					m_counter++ ;
+						s->object = nullptr ;
+					}
+				} ) ;
+			}
+			explicit operator bool() const
+			{
+				return m_state != nullptr ;
+			}
+			bool alive() const
+			{
+				QMutexLocker m( &m_state->mutex ) ;
 
-					if( m_task_not_run ){
+				return m_state->object != nullptr ;
+			}
+			/*
+			 * Posts "function" to the thread of the object,returns false if the object is gone.
+			 */
+			template< typename Function >
+			bool post( Function function ) const
+			{
+				QMutexLocker m( &m_state->mutex ) ;
 
-						m_task_not_run = false ;
+				if( m_state->object ){
 
-						m.unlock() ;
+					QMetaObject::invokeMethod( m_state->object,std::move( function ),Qt::QueuedConnection ) ;
 
-						it.second() ;
+					return true ;
+				}else{
+					return false ;
+				}
+			}
+			/*
+			 * Calls "function" on the thread of the object after "msec" milliseconds,it must be
+			 * called from that thread.
+			 */
+			template< typename Function >
+			bool post( int msec,Function function ) const
+			{
+				QMutexLocker m( &m_state->mutex ) ;
 
-						m_when_any_function() ;
-					}else{
-						m.unlock() ;
-						it.second() ;
-					}
+				if( m_state->object ){
 
-					if( m_counter == m_tasks.size() ){
+					QTimer::singleShot( msec,m_state->object,std::move( function ) ) ;
 
-						this->deleteLater() ;
-					}
-				} ) ;
+					return true ;
+				}else{
+					return false ;
+				}
 			}
-		}
-		void _queue()
+		private:
+			struct state
+			{
+				state( QObject * e ) : object( e )
+				{
+				}
+				~state()
+				{
+					QObject::disconnect( connection ) ;
+				}
+				QMutex mutex ;
+				QObject * object ;
+				QMetaObject::Connection connection ;
+			};
+			std::shared_ptr< state > m_state ;
+		};
+
+		/*
+		 * Delivers the result of a task that finished on a worker thread.
+		 *
+		 * By default,the delivery is posted straight to the thread that owns the future. Posted
+		 * calls are processed by any running event loop of that thread,including nested ones
+		 * started by .await(),unlike the deleteLater() that deletes the task.
+		 *
+		 * A continuation given with a context object is posted to the thread of that object
+		 * together with the result so that it does not depend on the task still being alive
+		 * and a continuation given with Task::inline_continuation runs on the worker.
+		 */
+		class delivery
 		{
-			m_tasks[ m_counter ].first->then( [ this ](){
+		public:
+			template< typename Future,typename Result >
+			void deliver( Future& future,QObject * owner,Result& result )
+			{
+				if( future.m_inline ){
 
-				m_tasks[ m_counter ].second() ;
+					m_delivered = true ;
 
-				m_counter++ ;
+					future.run( std::move( result ) ) ;
 
-				if( m_counter == m_tasks.size() ){
+				}else if( future.m_context ){
 
-					m_function() ;
+					m_delivered = true ;
 
-					this->deleteLater() ;
+					this->post( future.m_context,future.continuation( std::move( result ) ),future.m_managed ) ;
 				}else{
-					this->_queue() ;
-				}
-			} ) ;
-		}
+					m_finished = std::chrono::steady_clock::now() ;
 
-		void _start()
-		{
-			for( auto& it : m_tasks ){
+					QMetaObject::invokeMethod( owner,[ this,&future,&result ](){
 
-				it.first->then( [ & ](){
+						m_delivered = true ;
 
-					QMutexLocker m( &m_mutex ) ;
+						delivery::record( m_finished ) ;
 
-					Q_UNUSED( m ) ;
+						future.run( std::move( result ) ) ;
 
-					m_counter++ ;
+					},Qt::QueuedConnection ) ;
+				}
+			}
+			template< typename Future >
+			void deliver( Future& future,QObject * owner )
+			{
+				if( future.m_inline ){
 
-					it.second() ;
+					m_delivered = true ;
 
-					if( m_counter == m_tasks.size() ){
+					future.run() ;
 
-						m_function() ;
+				}else if( future.m_context ){
 
-						this->deleteLater() ;
-					}
-				} ) ;
-			}
-		}
+					m_delivered = true ;
 
-		QThread * m_thread = nullptr ;
+					this->post( future.m_context,future.continuation(),future.m_managed ) ;
+				}else{
+					m_finished = std::chrono::steady_clock::now() ;
 
-		std::function< void() > m_function = [](){} ;
-		std::function< void() > m_start    = [](){} ;
-		std::function< void() > m_cancel   = [](){} ;
-		std::function< void() > m_get      = [](){} ;
-		std::function< void() > m_when_any_function ;
-		QMutex m_mutex ;
-		std::vector< std::pair< Task::future< void > *,std::function< void() > > > m_tasks ;
-		std::vector< QThread * > m_threads ;
-		decltype( m_tasks.size() ) m_counter = 0 ;
-		bool m_task_not_run = true ;
-	};
+					QMetaObject::invokeMethod( owner,[ this,&future ](){
 
-	namespace detail
-	{
-		/*
-		 * -------------------------Start of internal helper functions-------------------------
-		 */
-		template< typename Type,typename Function >
-		class ThreadHelper : public QThread
-		{
-		public:
-			ThreadHelper( Function function ) :
-				m_function( std::move( function ) ),
-				m_future( this,
-					  [ this ](){ this->start() ; },
-					  [ this ](){ this->deleteLater() ; },
-					  [ this ](){ this->deleteLater() ; return m_function() ; } )
-			{
-				connect( this,&QThread::finished,this,&QThread::deleteLater ) ;
+						m_delivered = true ;
+
+						delivery::record( m_finished ) ;
+
+						future.run() ;
+
+					},Qt::QueuedConnection ) ;
+				}
 			}
-			Task::future<Type>& Future()
+			/*
+			 * Tasks whose results were not delivered deliver them from their destructors.
+			 */
+			bool pending() const
 			{
-				return m_future ;
+				return !m_delivered ;
 			}
 		private:
-			~ThreadHelper()
+			using time_point = std::chrono::steady_clock::time_point ;
+
+			/*
+			 * A continuation posted to a context object. The continuation of a future that is
+			 * managed by another future also does the bookkeeping of the managing future and
+			 * it runs from the destructor if it was dropped because the object is gone,the
+			 * managing future skips the functions it would call in that case.
+			 */
+			template< typename Function >
+			class posted
+			{
+			public:
+				posted( Function function,time_point finished,bool managed ) :
+					m_function( std::move( function ) ),m_finished( finished ),m_pending( managed )
+				{
+				}
+				posted( posted&& e ) :
+					m_function( std::move( e.m_function ) ),m_finished( e.m_finished ),m_pending( e.m_pending )
+				{
+					e.m_pending = false ;
+				}
+				posted& operator=( posted&& ) = delete ;
+				void operator()()
+				{
+					m_pending = false ;
+
+					delivery::record( m_finished ) ;
+
+					m_function() ;
+				}
+				~posted()
+				{
+					if( m_pending ){
+
+						m_function() ;
+					}
+				}
+			private:
+				Function m_function ;
+				time_point m_finished ;
+				bool m_pending ;
+			};
+			template< typename Function >
+			void post( const Task::detail::object_guard& context,Function function,bool managed )
 			{
-				m_future.run( std::move( m_result ) ) ;
+				auto finished = std::chrono::steady_clock::now() ;
+
+				context.post( posted< Function >( std::move( function ),finished,managed ) ) ;
 			}
-			void run()
+			static void record( time_point finished )
 			{
-				m_result = m_function() ;
+				using ns = std::chrono::nanoseconds ;
+
+				auto e = std::chrono::steady_clock::now() - finished ;
+				auto latency = static_cast< std::uint64_t >( std::chrono::duration_cast< ns >( e ).count() ) ;
+
+				auto& m = Task::detail::statistics() ;
+
+				m.continuations.fetch_add( 1,std::memory_order_relaxed ) ;
+				m.continuation_latency.fetch_add( latency,std::memory_order_relaxed ) ;
+
+				auto max = m.max_continuation_latency.load( std::memory_order_relaxed ) ;
+
+				while( max < latency && !m.max_continuation_latency.compare_exchange_weak( max,latency ) ){
+				}
 			}
-			Function m_function ;
-			Task::future<Type> m_future ;
-			Type m_result ;
+			time_point m_finished ;
+			std::atomic< bool > m_delivered{ false } ;
 		};
 
-		template< typename Function>
-		class ThreadHelperVoid : public QThread
+		/*
+		 * A move only replacement for std::function.
+		 *
+		 * Callables that are small enough are stored inside the object and bigger ones
+		 * are stored on the heap. Unlike std::function,callables do not have to be copyable.
+		 */
+		template< typename Signature >
+		class move_only_function ;
+
+		template< typename R,typename ... Args >
+		class move_only_function< R( Args ... ) >
 		{
 		public:
-			ThreadHelperVoid( Function function ) :
-				m_function( std::move( function ) ),
-				m_future( this,
-					  [ this ](){ this->start() ; },
-					  [ this ](){ this->deleteLater() ; },
-					  [ this ](){ m_function() ; this->deleteLater() ; } )
+			move_only_function() = default ;
+			move_only_function( std::nullptr_t )
 			{
-				connect( this,&QThread::finished,this,&QThread::deleteLater ) ;
 			}
-			Task::future< void >& Future()
+			template< typename Function,
+				  std::enable_if_t<!std::is_same<std::decay_t<Function>,move_only_function>::value,int> = 0 >
+			move_only_function( Function function )
 			{
-				return m_future ;
+				using storage = move_only_function::storage< Function,move_only_function::is_local<Function>() > ;
+
+				storage::create( &m_buffer,std::move( function ) ) ;
+
+				m_invoke = &move_only_function::invoke< storage,Function > ;
+				m_manage = &storage::manage ;
 			}
-		private:
-			~ThreadHelperVoid()
+			move_only_function( move_only_function&& other ) noexcept
 			{
-				m_future.run() ;
+				this->take( other ) ;
 			}
-			void run()
+			move_only_function& operator=( move_only_function&& other ) noexcept
 			{
-				m_function() ;
+				if( this != &other ){
+
+					this->reset() ;
+					this->take( other ) ;
+				}
+
+				return *this ;
 			}
-			Function m_function ;
-			Task::future< void > m_future ;
+			move_only_function& operator=( std::nullptr_t ) noexcept
+			{
+				this->reset() ;
+
+				return *this ;
+			}
+			move_only_function( const move_only_function& ) = delete ;
+			move_only_function& operator=( const move_only_function& ) = delete ;
+			~move_only_function()
+			{
+				this->reset() ;
+			}
+			R operator()( Args ... args ) const
+			{
+				return m_invoke( &m_buffer,std::forward< Args >( args ) ... ) ;
+			}
+			explicit operator bool() const
+			{
+				return m_invoke != nullptr ;
+			}
+			friend bool operator==( const move_only_function& e,std::nullptr_t )
+			{
+				return !e ;
+			}
+			friend bool operator!=( const move_only_function& e,std::nullptr_t )
+			{
+				return static_cast< bool >( e ) ;
+			}
+		private:
+			enum class operation{ move,destroy } ;
+
+			static const std::size_t buffer_size = 4 * sizeof( void * ) ;
+
+			using buffer = std::aligned_storage_t< buffer_size,alignof( std::max_align_t ) > ;
+
+			template< typename Function >
+			static constexpr bool is_local()
+			{
+				/*
+				 * Callables stored inside the object must be nothrow movable for the
+				 * move constructor of this class to be noexcept.
+				 */
+				return sizeof( Function ) <= buffer_size &&
+				       alignof( Function ) <= alignof( buffer ) &&
+				       std::is_nothrow_move_constructible< Function >::value ;
+			}
+
+			template< typename Function,bool local >
+			struct storage ;
+
+			template< typename Function >
+			struct storage< Function,true >
+			{
+				static Function * get( void * e )
+				{
+					return static_cast< Function * >( e ) ;
+				}
+				static void create( void * e,Function&& function )
+				{
+					::new ( e ) Function( std::move( function ) ) ;
+				}
+				static void manage( operation op,void * src,void * dst )
+				{
+					auto function = storage::get( src ) ;
+
+					if( op == operation::move ){
+
+						::new ( dst ) Function( std::move( *function ) ) ;
+					}
+
+					function->~Function() ;
+				}
+			};
+
+			template< typename Function >
+			struct storage< Function,false >
+			{
+				static Function * get( void * e )
+				{
+					return *static_cast< Function ** >( e ) ;
+				}
+				static void create( void * e,Function&& function )
+				{
+					*static_cast< Function ** >( e ) = new Function( std::move( function ) ) ;
+				}
+				static void manage( operation op,void * src,void * dst )
+				{
+					if( op == operation::move ){
+
+						*static_cast< Function ** >( dst ) = storage::get( src ) ;
+					}else{
+						delete storage::get( src ) ;
+					}
+				}
+			};
+
+			template< typename Storage,typename Function >
+			static R invoke( void * e,Args&& ... args )
+			{
+				return static_cast< R >( ( *Storage::get( e ) )( std::forward< Args >( args ) ... ) ) ;
+			}
+			void take( move_only_function& other ) noexcept
+			{
+				if( other.m_invoke ){
+
+					other.m_manage( operation::move,&other.m_buffer,&m_buffer ) ;
+
+					m_invoke = other.m_invoke ;
+					m_manage = other.m_manage ;
+
+					other.m_invoke = nullptr ;
+					other.m_manage = nullptr ;
+				}
+			}
+			void reset() noexcept
+			{
+				if( m_invoke ){
+
+					m_manage( operation::destroy,&m_buffer,nullptr ) ;
+
+					m_invoke = nullptr ;
+					m_manage = nullptr ;
+				}
+			}
+			R ( *m_invoke )( void *,Args&& ... ) = nullptr ;
+			void ( *m_manage )( operation,void *,void * ) = nullptr ;
+			mutable buffer m_buffer ;
 		};
-		template<typename Fn,Task::detail::returns_value<Fn> = 0>
-		Task::future<Task::detail::result_of<Fn>>& run( Fn function )
-		{
-			using t = Task::detail::result_of<Fn> ;
 
-			return ( new ThreadHelper<t,Fn>( std::move( function ) ) )->Future() ;
-		}
-		template<typename Fn,Task::detail::returns_void<Fn> = 0>
-		Task::future<Task::detail::result_of<Fn>>& run( Fn function )
-		{
-			return ( new ThreadHelperVoid<Fn>( std::move( function ) ) )->Future() ;
-		}
+		/*
+		 * Implemented by objects that power a future that runs its own task.
+		 *
+		 * task_run() runs the task on its backend and passes its result to the given function
+		 * on the thread that ran it,without going through the event loop of the thread that
+		 * owns the future. Tasks that can not do that run on the calling thread.
+		 *
+		 * task_wait() powers future::wait() and blocks until the task finishes,tasks that manage
+		 * other tasks use it to run them concurrently instead of one after another.
+		 */
 		template< typename T >
-		void add( Task::future< T >& a,Task::future< T >& b,std::function< void( T ) >&& c )
+		class task
 		{
-			a.m_tasks.emplace_back( std::addressof( b ),std::move( c ) ) ;
-			a.m_threads.push_back( b.m_thread ) ;
-		}
+		public:
+			virtual void task_start() = 0 ;
+			virtual void task_cancel() = 0 ;
+			virtual T task_get() = 0 ;
+			virtual void task_run( Task::detail::move_only_function< void( T ) > function )
+			{
+				function( this->task_get() ) ;
+			}
+			virtual T task_wait()
+			{
+				return this->task_get() ;
+			}
+		protected:
+			~task() = default ;
+		};
 
-		template< typename T >
-		void add_void( Task::future< T >& a,Task::future< T >& b,std::function< T() >&& c )
+		template<>
+		class task< void >
 		{
-			a.m_tasks.emplace_back( std::addressof( b ),std::move( c ) ) ;
-			a.m_threads.push_back( b.m_thread ) ;
-		}
+		public:
+			virtual void task_start() = 0 ;
+			virtual void task_cancel() = 0 ;
+			virtual void task_get() = 0 ;
+			virtual void task_run( Task::detail::move_only_function< void() > function )
+			{
+				this->task_get() ;
+				function() ;
+			}
+			virtual void task_wait()
+			{
+				this->task_get() ;
+			}
+		protected:
+			~task() = default ;
+		};
 
-		template< typename T >
-		void add_task( Task::future< T >& f )
+#if __cplusplus >= 201703L
+		template<typename Function,typename ... Args>
+		using result_of = std::invoke_result_t<Function,Args ...> ;
+#else
+		template<typename Function,typename ... Args>
+		using result_of = std::result_of_t<Function(Args ...)> ;
+#endif
+		template<typename ReturnType,typename Function,typename ... Args>
+		using has_same_return_type = std::enable_if_t<std::is_same<result_of<Function,Args...>,ReturnType>::value,int> ;
+
+		template<typename Function,typename ... Args>
+		using has_void_return_type = has_same_return_type<void,Function,Args...> ;
+
+		template<typename Function,typename ... Args>
+		using has_bool_return_type = has_same_return_type<bool,Function,Args...> ;
+
+		template<typename Function,typename ... Args>
+		using has_non_void_return_type = std::enable_if_t<!std::is_void<result_of<Function,Args...>>::value,int> ;
+
+		template<typename Function,typename ... Args>
+		using has_argument = has_same_return_type<result_of<Function,Args...>,Function,Args...> ;
+
+		template<typename Function>
+		using has_no_argument = has_same_return_type<result_of<Function>,Function> ;
+
+		template<typename Function,typename ... Args>
+		using returns_void = has_void_return_type<Function,Args...> ;
+
+		template<typename Function,typename ... Args>
+		using returns_value = has_non_void_return_type<Function,Args...> ;
+
+		template<typename Function>
+		using not_executor = std::enable_if_t<!std::is_base_of<Task::executor,std::decay_t<Function>>::value,int> ;
+
+		template< typename Range,typename = void >
+		struct is_range : std::false_type
 		{
-			Q_UNUSED( f )
-		}
+		};
 
-		template< typename T >
-		void add_future( Task::future< T >& f )
+		template< typename Range >
+		struct is_range< Range,decltype( void( std::begin( std::declval< Range& >() ) ),
+						 void( std::end( std::declval< Range& >() ) ) ) > : std::true_type
 		{
-			Q_UNUSED( f )
-		}
+		};
 
-		template< typename T >
-		void add_pair( Task::future< T >& f )
+		/*
+		 * Elements of a range that refer to a future,Task::future<T> * or
+		 * std::reference_wrapper< Task::future<T> >.
+		 */
+		template< typename E >
+		struct future_reference : std::false_type
 		{
-			Q_UNUSED( f )
-		}
+		};
 
 		template< typename T >
-		void add_pair_void( Task::future< T >& f )
+		struct future_reference< Task::future< T > * > : std::true_type
 		{
-			Q_UNUSED( f )
-		}
-
-		template< typename ... T,
-			  typename Function,
-			  Task::detail::not_copyable<Function> = 0 >
-		void add_task( Task::future< void >& f,Function e,T&& ... t ) ;
+			using type = T ;
 
-		template< typename ... T,
-			  typename Function,
-			  Task::detail::copyable<Function> = 0 >
-		void add_task( Task::future< void >& f,Function e,T&& ... t )
-		{
-			add_void( f,Task::detail::run( std::function< void() >( std::move( e ) ) ),
-				  std::function< void() >( [](){} ) ) ;
-			add_task( f,std::forward<T>( t ) ... ) ;
-		}
+			static Task::future< T >& get( Task::future< T > * e )
+			{
+				return *e ;
+			}
+		};
 
-		template< typename ... T,
-			  typename Function,
-			  Task::detail::not_copyable<Function> >
-		void add_task( Task::future< void >& f,Function e,T&& ... t )
+		template< typename T >
+		struct future_reference< std::reference_wrapper< Task::future< T > > > : std::true_type
 		{
-			auto a = std::function< void() >( Task::detail::function( std::move( e ) ) ) ;
+			using type = T ;
 
-			add_void( f,Task::detail::run( std::move( a ) ),
-				  std::function< void() >( [](){} ) ) ;
-
-			add_task( f,std::forward<T>( t ) ... ) ;
-		}
+			static Task::future< T >& get( std::reference_wrapper< Task::future< T > > e )
+			{
+				return e.get() ;
+			}
+		};
 
-		template< typename ... T >
-		void add_future( Task::future< void >& f,Task::future< void >& e,T&& ... t )
-		{
-			add_void( f,e,std::function< void() >( [](){} ) ) ;
-			add_future( f,std::forward<T>( t ) ... ) ;
-		}
+		template< typename Range >
+		using range_value = std::decay_t< decltype( *std::begin( std::declval< Range& >() ) ) > ;
 
-		template< typename E,typename F,typename ... T >
-		void add_pair( Task::future< E >& f,F&& s,T&& ... t )
+		template< typename Range,typename = void >
+		struct is_range_of_futures : std::false_type
 		{
-			add( f,Task::detail::run( std::move( s.value.first ) ),std::move( s.value.second ) ) ;
-			add_pair( f,std::forward<T>( t ) ... ) ;
-		}
+		};
 
-		template< typename F,typename ... T >
-		void add_pair_void( Task::future< void >& f,F&& s,T&& ... t )
+		template< typename Range >
+		struct is_range_of_futures< Range,std::enable_if_t< is_range< Range >::value > > :
+			future_reference< range_value< Range > >
 		{
-			add_void( f,Task::detail::run( std::move( s.value.first ) ),std::move( s.value.second ) ) ;
-			add_pair_void( f,std::forward<T>( t ) ... ) ;
-		}
+		};
 
-		template< typename T >
-		Task::future< T >& future()
-		{
-			return *( new Task::future< T >() ) ;
-		}
+		template< typename Range >
+		using range_of_futures = std::enable_if_t< is_range_of_futures< Range >::value,int > ;
 
-	} //end of detail namespace
+		template< typename Range >
+		using range_of_callables = std::enable_if_t< is_range< Range >::value &&
+							     !is_range_of_futures< Range >::value,int > ;
 
+		template< typename Range >
+		using range_future_type = typename future_reference< range_value< Range > >::type ;
 
-	/*
-	 * -------------------------End of internal helper functions-------------------------
-	 */
-	template< typename Fn,Task::detail::copyable<Fn> = 0 >
-	auto& run( Fn function )
-	{
-		return Task::detail::run( std::move( function ) ) ;
-	}
-	template< typename Fn,Task::detail::not_copyable<Fn> = 0 >
-	auto& run( Fn function )
-	{
-		return Task::detail::run( Task::detail::function( std::move( function ) ) ) ;
-	}
-#if __cplusplus > 201703L
-	template< typename Fn,typename ... Args >
-	future<std::invoke_result_t<Fn,Args...>>& run( Fn function,Args ... args )
-	{
-		return Task::run( [ function = std::move( function ),... args = std::move( args ) ]()mutable{
+		template< typename T >
+		void add_void( Task::future< T >&,Task::future< T >&,Task::detail::move_only_function< T() >&& ) ;
+		template< typename T >
+		void add( Task::future< T >&,Task::future< T >&,Task::detail::move_only_function< void( T ) >&& ) ;
 
-			return function( std::move( args ) ... ) ;
-		} ) ;
-	}
-#elif __cplusplus == 201703L
-	template< typename Fn,typename ... Args >
-	future<std::invoke_result_t<Fn,Args...>>& run( Fn function,Args ... args )
-	{
-		return Task::run( [ args = std::make_tuple( std::move( args ) ... ),function = std::move( function ) ]()mutable{
+		template< typename T,typename U,typename Function >
+		class stage ;
 
-			return std::apply( [ function = std::move( function ) ]( Args ... args ){
+		template< typename T >
+		Task::future< T >& serial( Task::future< T >& ) ;
 
-				return function( std::move( args ) ... ) ;
+		template< typename Results,typename Derived >
+		class collector ;
 
-			},std::move( args ) ) ;
-		} ) ;
+		template< typename Function,typename T >
+		Task::future< Task::detail::result_of< Function,T > >& next( Task::future< T >&,Function ) ;
+		template< typename Function >
+		Task::future< Task::detail::result_of< Function > >& next( Task::future< void >&,Function ) ;
 	}
-#else
-	template< typename Fn,typename ... Args >
-	future<std::result_of_t<Fn(Args...)>>& run( Fn function,Args ... args )
-	{
-		return Task::run( [ =,function = std::move( function ) ](){
 
-			return function( std::move( args ) ... ) ;
-		} ) ;
-	}
-#endif
-	class progress : public QObject{
-		Q_OBJECT
-	public:
-		template< typename function >
-		progress( QObject * obj,function fn )
+	template< typename T >
+	struct pair{
+		pair( Task::detail::move_only_function< T() > first,
+		      Task::detail::move_only_function< void( T ) > second ) :
+			value( std::move( first ),std::move( second ) )
 		{
-			connect( this,&progress::update,obj,std::move( fn ) ) ;
 		}
-	signals:
-		void update( QVariant x ) const ;
-	private:
+		std::pair< Task::detail::move_only_function< T() >,
+			   Task::detail::move_only_function< void( T ) > > value ;
 	};
 
-	template< typename Fn,typename cb >
-	future<Task::detail::result_of<Fn,const progress&>>& run( QObject * obj,Fn function,cb rp )
-	{
-		return Task::run( [ obj,rp = std::move( rp ),function = std::move( function ) ](){
-
-			return function( progress( obj,std::move( rp ) ) ) ;
-		} ) ;
-	}
-
-	template< typename Function,
-		  Task::detail::copyable<Function> = 0,
-		  typename ... T >
-	Task::future< void >& run_tasks( Function f,T ... t )
+	template<>
+	struct pair<void>{
+		pair( Task::detail::move_only_function< void() > first,
+		      Task::detail::move_only_function< void() > second ) :
+			value( std::move( first ),std::move( second ) )
+		{
+		}
+		std::pair< Task::detail::move_only_function< void() >,
+			   Task::detail::move_only_function< void() > > value ;
+	};
+	template< typename E,typename F >
+	pair<Task::detail::result_of<E>> make_pair( E e,F f )
 	{
-		auto& e = Task::detail::future< void >() ;
-		Task::detail::add_task( e,std::move( f ),std::move( t ) ... ) ;
-		return e ;
+		return pair<Task::detail::result_of<E>>( std::move( e ),std::move( f ) ) ;
 	}
-	template< typename Function,
-		  Task::detail::not_copyable<Function> = 0,
-		  typename ... T >
-	Task::future< void >& run_tasks( Function f,T ... t )
+	template< typename T >
+	class future : private QObject
 	{
-		auto& e = Task::detail::future< void >() ;
-		Task::detail::add_task( e,Task::detail::function( std::move( f ) ),std::move( t ) ... ) ;
-		return e ;
-	}
+	public:
+		/*
+		 * Use this API if you care about the result
+		 */
+		//void( T )
+		template<typename Function,
+			Task::detail::has_argument<Function,T> = 0>
+		void then( Function function )
+		{
+			m_function = std::move( function ) ;
+			this->start() ;
+		}
+		/*
+		 * Use this API if you DO NOT care about the result
+		 */
+		//void( void )
+		template<typename Function,
+			Task::detail::has_no_argument<Function> = 0>
+		void then( Function function )
+		{
+			m_function_1 = std::move( function ) ;
+			this->start() ;
+		}
+		/*
+		 * Runs the continuation in the thread of the context object instead of the thread
+		 * that owns this future. The continuation is not called if the object is deleted
+		 * before it runs,a future that manages other futures still runs them all and
+		 * deletes itself but it does not call the functions it was given.
+		 */
+		template<typename Function>
+		void then( QObject * context,Function function )
+		{
+			m_context = Task::detail::object_guard( context ) ;
+			this->then( std::move( function ) ) ;
+		}
+		/*
+		 * Runs the continuation directly on the worker thread that finished the task.
+		 * Use it for short continuations that do not touch objects of other threads.
+		 */
+		template<typename Function>
+		void then( Task::inline_continuation_t,Function function )
+		{
+			m_inline = true ;
+			this->then( std::move( function ) ) ;
+		}
+		/*
+		 * Returns a future whose result is the result of the function called with the result
+		 * of this future. The function runs on the worker that ran the task of this future
+		 * right after the task finishes and a chain of .next() calls runs on one worker
+		 * without going back to the thread that owns the futures between stages.
+		 */
+		template<typename Function>
+		Task::future< Task::detail::result_of< Function,T > >& next( Function function )
+		{
+			return Task::detail::next( *this,std::move( function ) ) ;
+		}
+		template<typename Function,
+			 Task::detail::has_no_argument<Function> = 0>
+		void queue( Function function )
+		{
+			if( this->manages_multiple_futures() ){
+
+				m_function_1 = std::move( function ) ;
+
+				this->_queue() ;
+			}else{
+				this->then( std::move( function ) ) ;
+			}
+		}
+
+		void queue()
+		{
+			if( this->manages_multiple_futures() ){
+
+				m_function_1 = [](){} ;
+
+				this->_queue() ;
+			}else{
+				this->then( [](){} ) ;
+			}
+		}
+		/*
+		 * Below two API just exposes existing functionality using more standard names
+		 */
+		template<typename Function>
+		void when_all( Function function )
+		{
+			this->then( std::move( function ) ) ;
+		}
+		template<typename Function>
+		void when_seq( Function function )
+		{
+			this->queue( std::move( function ) ) ;
+		}
+		template<typename Function,
+			 Task::detail::has_no_argument<Function> = 0>
+		void when_any( Function function )
+		{
+			if( this->manages_multiple_futures() ){
+
+				this->_when_any( std::move( function ) ) ;
+			}else{
+				this->then( std::move( function ) ) ;
+			}
+		}
+		void when_all()
+		{
+			this->then( [](){} ) ;
+		}
+		void when_seq()
+		{
+			this->queue( [](){} ) ;
+		}
+		void when_any()
+		{
+			if( this->manages_multiple_futures() ){
+
+				this->_when_any( [](){} ) ;
+			}else{
+				this->then( [](){} ) ;
+			}
+		}
+		T get()
+		{
+			if( this->manages_multiple_futures() ){
+
+				for( auto& it : m_tasks ){
+
+					it.second( it.first->get() ) ;
+				}
+
+				this->deleteLater() ;
+
+				return T() ;
+			}else if( m_task ){
+
+				return m_task->task_get() ;
+			}else{
+				return T() ;
+			}
+		}
+		/*
+		 * Same as .get() but tasks managed by this future run concurrently on their backends
+		 * and the calling thread is blocked until all of them finish,it does not need an event
+		 * loop. Continuations of pairs run afterwards on the calling thread in the order the
+		 * pairs were given.
+		 *
+		 * Called from a task of Task::thread_pool(),of a strand or from a worker of a scheduler,
+		 * managed tasks could be queued behind the blocked thread and this function behaves
+		 * like .get() and runs them on the calling thread one after another instead.
+		 */
+		T wait()
+		{
+			if( this->manages_multiple_futures() ){
+
+				if( Task::detail::on_bounded_pool() ){
+
+					return this->get() ;
+				}
+
+				QSemaphore s ;
+
+				this->_wait( [ &s ](){ s.release() ; } ) ;
+
+				s.acquire() ;
+
+				this->_wait_finished() ;
+
+				this->deleteLater() ;
+
+				return T() ;
+
+			}else if( m_task ){
+
+				return m_task->task_wait() ;
+			}else{
+				return T() ;
+			}
+		}
+		T await()
+		{
+			QEventLoop p ;
+
+			T q ;
+
+			bool finished = false ;
+
+			m_function = [ & ]( T&& r ){ q = std::move( r ) ; finished = true ; p.exit() ; } ;
+
+			this->start() ;
+
+			if( !finished ){
+
+				p.exec() ;
+			}
+
+			return q ;
+		}
+		bool manages_multiple_futures()
+		{
+			return m_tasks.size() > 0 ;
+		}
+		/*
+		 * Limits the number of managed tasks,or of futures that were given as a range to
+		 * Task::when_all(),that run at the same time to "count". The rest are started one
+		 * by one as earlier ones finish. 0 means no limit.
+		 */
+		future& max_in_flight( std::size_t count )
+		{
+			m_max_in_flight = count ;
+
+			return *this ;
+		}
+		const std::vector< QThread * >& all_threads()
+		{
+			return m_threads ;
+		}
+		QThread * first_thread()
+		{
+			return m_threads[ 0 ] ;
+		}
+		QThread * thread_at( std::vector< QThread * >::size_type s )
+		{
+			return m_threads[ s ] ;
+		}
+		void start()
+		{
+			if( this->manages_multiple_futures() ){
+
+				this->_start() ;
+
+			}else if( m_task ){
+
+				m_task->task_start() ;
+			}
+		}
+		void cancel()
+		{
+			if( this->manages_multiple_futures() ){
+
+				for( auto& it : m_tasks ){
+
+					it.first->cancel() ;
+				}
+
+				this->deleteLater() ;
+
+			}else if( m_task ){
+
+				m_task->task_cancel() ;
+			}
+		}
+		future() = default ;
+		future( const future& ) = delete ;
+		future( future&& ) = delete ;
+		future& operator=( const future& ) = delete ;
+		future& operator=( future&& ) = delete ;
+
+		future( QThread * e,Task::detail::task< T > * task ) :
+			m_thread( e ),
+			m_task( task )
+		{
+			/*
+			 * m_thread is nullptr if this future is powered by Task::thread_pool()
+			 * and the entry is kept to keep .all_threads() in the same order as tasks.
+			 */
+			m_threads.push_back( m_thread ) ;
+		}
+		/*
+		 * The continuation is moved out before it is called because it can start an event
+		 * loop that deletes the object that owns this future.
+		 */
+		void run( T&& r )
+		{
+			if( m_function_1 != nullptr ){
+
+				auto function = std::move( m_function_1 ) ;
+
+				function() ;
+
+			}else if( m_function != nullptr ){
+
+				auto function = std::move( m_function ) ;
+
+				function( std::move( r ) ) ;
+			}
+		}
+
+		template< typename E >
+		friend void Task::detail::add( Task::future< E >&,
+					  Task::future< E >&,
+					  Task::detail::move_only_function< void( E ) >&& ) ;
+		friend class Task::detail::delivery ;
+		template< typename E,typename U,typename Function >
+		friend class Task::detail::stage ;
+		template< typename E >
+		friend Task::future< E >& Task::detail::serial( Task::future< E >& ) ;
+		template< typename Results,typename Derived >
+		friend class Task::detail::collector ;
+	private:
+		/*
+		 * The continuation together with the result it will be called with.
+		 */
+		Task::detail::move_only_function< void() > continuation( T&& r )
+		{
+			if( m_function_1 != nullptr ){
+
+				return std::move( m_function_1 ) ;
+
+			}else if( m_function != nullptr ){
+
+				auto function = std::move( m_function ) ;
+
+				return [ function = std::move( function ),r = std::move( r ) ]()mutable{
+
+					function( std::move( r ) ) ;
+				} ;
+			}else{
+				return [](){} ;
+			}
+		}
+		/*
+		 * Managed futures deliver to where this future was asked to deliver.
+		 */
+		void _forward( Task::future< T >& e )
+		{
+			e.m_context = m_context ;
+			e.m_inline = m_inline ;
+			e.m_managed = true ;
+		}
+		/*
+		 * Continuations of managed futures still run if the context object is gone,the
+		 * functions they would call are skipped then.
+		 */
+		bool _alive() const
+		{
+			return !m_context || m_context.alive() ;
+		}
+		void _run( Task::detail::move_only_function< void( T ) > function )
+		{
+			if( this->manages_multiple_futures() ){
+
+				/*
+				 * Continuations of pairs run on the thread that finished the last task.
+				 */
+				this->_wait( [ this,function = std::move( function ) ]()mutable{
+
+					this->_wait_finished() ;
+
+					function( T() ) ;
+
+					this->deleteLater() ;
+				} ) ;
+
+			}else if( m_task ){
+
+				m_task->task_run( std::move( function ) ) ;
+			}else{
+				function( T() ) ;
+			}
+		}
+		/*
+		 * Runs managed tasks on their backends,futures that manage other futures included,
+		 * and calls "function" on the thread that finished the last of them. Results are kept
+		 * for ._wait_finished() that runs continuations of pairs in the order they were given.
+		 */
+		void _wait( Task::detail::move_only_function< void() > function )
+		{
+			m_results.reset( new T[ m_tasks.size() ]() ) ;
+
+			this->_set_multiple() ;
+
+			m_wait_function = std::move( function ) ;
+
+			this->_launch( &future::_wait_at ) ;
+		}
+		void _wait_at( std::size_t i )
+		{
+			auto done = [ this,i ]( T e ){
+
+				m_results[ i ] = std::move( e ) ;
+
+				this->_launch_next( &future::_wait_at ) ;
+
+				if( m_counter.fetch_add( 1 ) + 1 == m_tasks.size() ){
+
+					auto function = std::move( m_wait_function ) ;
+
+					function() ;
+				}
+			} ;
+
+			auto e = m_tasks[ i ].first ;
+
+			if( m_multiple[ i ] ){
+
+				e->_wait( [ done ](){ done( T() ) ; } ) ;
+			}else{
+				e->_run( std::move( done ) ) ;
+			}
+		}
+		void _wait_finished()
+		{
+			for( decltype( m_tasks.size() ) i = 0 ; i < m_tasks.size() ; i++ ){
+
+				if( m_multiple[ i ] ){
+
+					auto e = m_tasks[ i ].first ;
+
+					e->_wait_finished() ;
+
+					e->deleteLater() ;
+				}
+
+				m_tasks[ i ].second( std::move( m_results[ i ] ) ) ;
+			}
+		}
+		/*
+		 * A managed future that does not manage other futures is deleted by the thread that
+		 * owns it once its task finished and it must not be looked at afterwards,which of
+		 * them manage other futures is therefore noted before they are started.
+		 */
+		void _set_multiple()
+		{
+			m_multiple.reset( new bool[ m_tasks.size() ] ) ;
+
+			for( decltype( m_tasks.size() ) i = 0 ; i < m_tasks.size() ; i++ ){
+
+				m_multiple[ i ] = m_tasks[ i ].first->manages_multiple_futures() ;
+			}
+		}
+		void _when_any( Task::detail::move_only_function< void() > function )
+		{
+			m_when_any_function = std::move( function ) ;
+
+			this->_launch( &future::_when_any_at ) ;
+		}
+		void _when_any_at( std::size_t i )
+		{
+			this->_forward( *m_tasks[ i ].first ) ;
+
+			m_tasks[ i ].first->then( [ this,i ]( T&& e ){
+
+				if( this->_alive() ){
+
+					QMutexLocker m( &m_mutex ) ;
+
+					Q_UNUSED( m ) ;
+
+					m_tasks[ i ].second( std::forward<T>( e ) ) ;
+
+					if( m_task_not_run.exchange( false ) ){
+
+						m_when_any_function() ;
+					}
+				}
+
+				this->_launch_next( &future::_when_any_at ) ;
+
+				if( m_counter.fetch_add( 1 ) + 1 == m_tasks.size() ){
+
+					this->deleteLater() ;
+				}
+			} ) ;
+		}
+		void _queue()
+		{
+			if( m_serial ){
+
+				/*
+				 * Managed tasks run on a strand that keeps them in order.
+				 */
+				this->_start() ;
+
+				return ;
+			}
+
+			this->_forward( *m_tasks[ m_counter ].first ) ;
+
+			m_tasks[ m_counter ].first->then( [ this ]( T&& e ){
+
+				auto alive = this->_alive() ;
+
+				if( alive ){
+
+					m_tasks[ m_counter ].second( std::forward<T>( e ) ) ;
+				}
+
+				m_counter++ ;
+
+				if( m_counter == m_tasks.size() ){
+
+					if( alive ){
+
+						m_function_1() ;
+					}
+
+					this->deleteLater() ;
+				}else{
+					this->_queue() ;
+				}
+			} ) ;
+		}
+		void _start()
+		{
+			this->_launch( &future::_start_at ) ;
+		}
+		void _start_at( std::size_t i )
+		{
+			this->_forward( *m_tasks[ i ].first ) ;
+
+			m_tasks[ i ].first->then( [ this,i ]( T&& e ){
+
+				auto alive = this->_alive() ;
+
+				if( alive ){
+
+					QMutexLocker m( &m_mutex ) ;
+
+					Q_UNUSED( m ) ;
+
+					m_tasks[ i ].second( std::forward<T>( e ) ) ;
+				}
+
+				this->_launch_next( &future::_start_at ) ;
+
+				if( m_counter.fetch_add( 1 ) + 1 == m_tasks.size() ){
+
+					if( alive && m_function_1 != nullptr ){
+
+						m_function_1() ;
+
+					}else if( alive && m_function != nullptr ){
+
+						m_function( T() ) ;
+					}
+
+					this->deleteLater() ;
+				}
+			} ) ;
+		}
+		/*
+		 * Starts the first managed tasks,all of them or at most m_max_in_flight of them,
+		 * and each finished task starts the next one.
+		 */
+		void _launch( void( future::*start )( std::size_t ) )
+		{
+			auto s = m_tasks.size() ;
+
+			if( m_max_in_flight > 0 && m_max_in_flight < s ){
+
+				s = m_max_in_flight ;
+			}
+
+			m_next = s ;
+
+			for( std::size_t i = 0 ; i < s ; i++ ){
+
+				( this->*start )( i ) ;
+			}
+		}
+		void _launch_next( void( future::*start )( std::size_t ) )
+		{
+			auto i = m_next.fetch_add( 1 ) ;
+
+			if( i < m_tasks.size() ){
+
+				( this->*start )( i ) ;
+			}
+		}
+
+		QThread * m_thread = nullptr ;
+		Task::detail::move_only_function< void( T ) > m_function = nullptr ;
+		Task::detail::move_only_function< void() > m_function_1  = nullptr ;
+		Task::detail::task< T > * m_task = nullptr ;
+		Task::detail::move_only_function< void() > m_when_any_function ;
+		Task::detail::move_only_function< void() > m_wait_function ;
+		Task::detail::object_guard m_context ;
+		bool m_inline = false ;
+		bool m_managed = false ;
+		bool m_serial = false ;
+
+		std::vector< std::pair< Task::future< T > *,Task::detail::move_only_function< void( T ) > > > m_tasks ;
+		std::vector< QThread * > m_threads ;
+		std::unique_ptr< T[] > m_results ;
+		std::unique_ptr< bool[] > m_multiple ;
+		/*
+		 * Children can finish on different threads,completion counting is lock free but
+		 * m_mutex keeps the continuations of pairs and of .when_any() from running at the
+		 * same time when they run inline on the workers that finished the children.
+		 */
+		QMutex m_mutex ;
+		std::atomic< decltype( m_tasks.size() ) > m_counter{ 0 } ;
+		std::atomic< std::size_t > m_next{ 0 } ;
+		std::size_t m_max_in_flight = 0 ;
+		std::atomic< bool > m_task_not_run{ true } ;
+	};
+
+	template<>
+	class future< void > : private QObject
+	{
+	public:
+		template<typename Function>
+		void then( Function function )
+		{
+			m_function = std::move( function ) ;
+			this->start() ;
+		}
+		/*
+		 * See future<T>::then( QObject *,Function )
+		 */
+		template<typename Function>
+		void then( QObject * context,Function function )
+		{
+			m_context = Task::detail::object_guard( context ) ;
+			this->then( std::move( function ) ) ;
+		}
+		/*
+		 * See future<T>::then( Task::inline_continuation_t,Function )
+		 */
+		template<typename Function>
+		void then( Task::inline_continuation_t,Function function )
+		{
+			m_inline = true ;
+			this->then( std::move( function ) ) ;
+		}
+		/*
+		 * See future<T>::next()
+		 */
+		template<typename Function>
+		Task::future< Task::detail::result_of< Function > >& next( Function function )
+		{
+			return Task::detail::next( *this,std::move( function ) ) ;
+		}
+		template<typename Function>
+		void queue( Function function )
+		{
+			if( this->manages_multiple_futures() ){
+
+				m_function = std::move( function ) ;
+
+				this->_queue() ;
+			}else{
+				this->then( std::move( function ) ) ;
+			}
+		}
+		void queue()
+		{
+			if( this->manages_multiple_futures() ){
+
+				m_function = [](){} ;
+
+				this->_queue() ;
+			}else{
+				this->then( [](){} ) ;
+			}
+		}
+		void when_any()
+		{
+			if( this->manages_multiple_futures() ){
+
+				this->_when_any( [](){} ) ;
+			}else{
+				this->then( [](){} ) ;
+			}
+		}
+		template<typename Function>
+		void when_any( Function function )
+		{
+			if( this->manages_multiple_futures() ){
+
+				this->_when_any( std::move( function ) ) ;
+			}else{
+				this->then( std::move( function ) ) ;
+			}
+		}
+		/*
+		 * Below two API just exposes existing functionality using more standard names
+		 */
+		template<typename Function>
+		void when_all( Function function )
+		{
+			this->then( std::move( function ) ) ;
+		}
+		template<typename Function>
+		void when_seq( Function function )
+		{
+			this->queue( std::move( function ) ) ;
+		}
+		void when_all()
+		{
+			this->then( [](){} ) ;
+		}
+		void when_seq()
+		{
+			this->queue() ;
+		}
+		void get()
+		{
+			if( this->manages_multiple_futures() ){
+
+				for( auto& it : m_tasks ){
+
+					it.first->get() ;
+					it.second() ;
+				}
+
+				this->deleteLater() ;
+			}else if( m_task ){
+
+				m_task->task_get() ;
+			}
+		}
+		/*
+		 * Same as .get() but tasks managed by this future run concurrently on their backends
+		 * and the calling thread is blocked until all of them finish,it does not need an event
+		 * loop. Continuations of pairs run afterwards on the calling thread in the order the
+		 * pairs were given.
+		 *
+		 * Called from a task of Task::thread_pool(),of a strand or from a worker of a scheduler,
+		 * managed tasks could be queued behind the blocked thread and this function behaves
+		 * like .get() and runs them on the calling thread one after another instead.
+		 */
+		void wait()
+		{
+			if( this->manages_multiple_futures() ){
+
+				if( Task::detail::on_bounded_pool() ){
+
+					this->get() ;
+
+					return ;
+				}
+
+				QSemaphore s ;
+
+				this->_wait( [ &s ](){ s.release() ; } ) ;
+
+				s.acquire() ;
+
+				this->_wait_finished() ;
+
+				this->deleteLater() ;
+
+			}else if( m_task ){
+
+				m_task->task_wait() ;
+			}
+		}
+		void await()
+		{
+			QEventLoop p ;
+
+			bool finished = false ;
+
+			m_function = [ & ](){ finished = true ; p.exit() ; } ;
+
+			this->start() ;
+
+			if( !finished ){
+
+				p.exec() ;
+			}
+		}
+		bool manages_multiple_futures()
+		{
+			return m_tasks.size() > 0 ;
+		}
+		/*
+		 * Limits the number of managed tasks,or of futures that were given as a range to
+		 * Task::when_all(),that run at the same time to "count". The rest are started one
+		 * by one as earlier ones finish. 0 means no limit.
+		 */
+		future& max_in_flight( std::size_t count )
+		{
+			m_max_in_flight = count ;
+
+			return *this ;
+		}
+		const std::vector< QThread * >& all_threads()
+		{
+			return m_threads ;
+		}
+		QThread * first_thread()
+		{
+			return m_threads[ 0 ] ;
+		}
+		QThread * thread_at( std::vector< QThread * >::size_type s )
+		{
+			return m_threads[ s ] ;
+		}
+		void start()
+		{
+			if( this->manages_multiple_futures() ){
+
+				this->_start() ;
+
+			}else if( m_task ){
+
+				m_task->task_start() ;
+			}
+		}
+		void cancel()
+		{
+			if( this->manages_multiple_futures() ){
+
+				for( auto& it : m_tasks ){
+
+					it.first->cancel() ;
+				}
+
+				this->deleteLater() ;
+
+			}else if( m_task ){
+
+				m_task->task_cancel() ;
+			}
+		}
+		future() = default ;
+		future( const future& ) = delete ;
+		future( future&& ) = delete ;
+		future& operator=( const future& ) = delete ;
+		future& operator=( future&& ) = delete ;
+
+		future( QThread * e,Task::detail::task< void > * task ) :
+			m_thread( e ),
+			m_task( task )
+		{
+			/*
+			 * m_thread is nullptr if this future is powered by Task::thread_pool()
+			 * and the entry is kept to keep .all_threads() in the same order as tasks.
+			 */
+			m_threads.push_back( m_thread ) ;
+		}
+
+		template< typename T >
+		friend void Task::detail::add_void( Task::future< T >&,
+						    Task::future< T >&,
+						    Task::detail::move_only_function< T() >&& ) ;
+		void run()
+		{
+			/*
+			 * See future<T>::run()
+			 */
+			auto function = std::move( m_function ) ;
+
+			if( function ){
+
+				function() ;
+			}
+		}
+		friend class Task::detail::delivery ;
+		template< typename E,typename U,typename Function >
+		friend class Task::detail::stage ;
+		template< typename E >
+		friend Task::future< E >& Task::detail::serial( Task::future< E >& ) ;
+		template< typename Results,typename Derived >
+		friend class Task::detail::collector ;
+	private:
+		Task::detail::move_only_function< void() > continuation()
+		{
+			return std::move( m_function ) ;
+		}
+		void _forward( Task::future< void >& e )
+		{
+			e.m_context = m_context ;
+			e.m_inline = m_inline ;
+			e.m_managed = true ;
+		}
+		/*
+		 * See future<T>::_alive()
+		 */
+		bool _alive() const
+		{
+			return !m_context || m_context.alive() ;
+		}
+		void _run( Task::detail::move_only_function< void() > function )
+		{
+			if( this->manages_multiple_futures() ){
+
+				this->_wait( [ this,function = std::move( function ) ]()mutable{
+
+					this->_wait_finished() ;
+
+					function() ;
+
+					this->deleteLater() ;
+				} ) ;
+
+			}else if( m_task ){
+
+				m_task->task_run( std::move( function ) ) ;
+			}else{
+				function() ;
+			}
+		}
+		/*
+		 * See future<T>::_wait()
+		 */
+		void _wait( Task::detail::move_only_function< void() > function )
+		{
+			this->_set_multiple() ;
+
+			m_wait_function = std::move( function ) ;
+
+			this->_launch( &future::_wait_at ) ;
+		}
+		void _wait_at( std::size_t i )
+		{
+			auto done = [ this ](){
+
+				this->_launch_next( &future::_wait_at ) ;
+
+				if( m_counter.fetch_add( 1 ) + 1 == m_tasks.size() ){
+
+					auto function = std::move( m_wait_function ) ;
+
+					function() ;
+				}
+			} ;
+
+			auto e = m_tasks[ i ].first ;
+
+			if( m_multiple[ i ] ){
+
+				e->_wait( std::move( done ) ) ;
+			}else{
+				e->_run( std::move( done ) ) ;
+			}
+		}
+		void _wait_finished()
+		{
+			for( decltype( m_tasks.size() ) i = 0 ; i < m_tasks.size() ; i++ ){
+
+				if( m_multiple[ i ] ){
+
+					auto e = m_tasks[ i ].first ;
+
+					e->_wait_finished() ;
+
+					e->deleteLater() ;
+				}
+
+				m_tasks[ i ].second() ;
+			}
+		}
+		/*
+		 * See future<T>::_set_multiple()
+		 */
+		void _set_multiple()
+		{
+			m_multiple.reset( new bool[ m_tasks.size() ] ) ;
+
+			for( decltype( m_tasks.size() ) i = 0 ; i < m_tasks.size() ; i++ ){
+
+				m_multiple[ i ] = m_tasks[ i ].first->manages_multiple_futures() ;
+			}
+		}
+		void _when_any( Task::detail::move_only_function< void() > function )
+		{
+			m_when_any_function = std::move( function ) ;
+
+			this->_launch( &future::_when_any_at ) ;
+		}
+		void _when_any_at( std::size_t i )
+		{
+			this->_forward( *m_tasks[ i ].first ) ;
+
+			m_tasks[ i ].first->then( [ this,i ](){
+
+				if( this->_alive() ){
+
+					QMutexLocker m( &m_mutex ) ;
+
+					Q_UNUSED( m ) ;
+
+					m_tasks[ i ].second() ;
+
+					if( m_task_not_run.exchange( false ) ){
+
+						m_when_any_function() ;
+					}
+				}
+
+				this->_launch_next( &future::_when_any_at ) ;
+
+				if( m_counter.fetch_add( 1 ) + 1 == m_tasks.size() ){
+
+					this->deleteLater() ;
+				}
+			} ) ;
+		}
+		void _queue()
+		{
+			if( m_serial ){
+
+				/*
+				 * Managed tasks run on a strand that keeps them in order.
+				 */
+				this->_start() ;
+
+				return ;
+			}
+
+			this->_forward( *m_tasks[ m_counter ].first ) ;
+
+			m_tasks[ m_counter ].first->then( [ this ](){
+
+				auto alive = this->_alive() ;
+
+				if( alive ){
+
+					m_tasks[ m_counter ].second() ;
+				}
+
+				m_counter++ ;
+
+				if( m_counter == m_tasks.size() ){
+
+					if( alive ){
+
+						m_function() ;
+					}
+
+					this->deleteLater() ;
+				}else{
+					this->_queue() ;
+				}
+			} ) ;
+		}
+
+		void _start()
+		{
+			this->_launch( &future::_start_at ) ;
+		}
+		void _start_at( std::size_t i )
+		{
+			this->_forward( *m_tasks[ i ].first ) ;
+
+			m_tasks[ i ].first->then( [ this,i ](){
+
+				auto alive = this->_alive() ;
+
+				if( alive ){
+
+					QMutexLocker m( &m_mutex ) ;
+
+					Q_UNUSED( m ) ;
+
+					m_tasks[ i ].second() ;
+				}
+
+				this->_launch_next( &future::_start_at ) ;
+
+				if( m_counter.fetch_add( 1 ) + 1 == m_tasks.size() ){
+
+					if( alive ){
+
+						m_function() ;
+					}
+
+					this->deleteLater() ;
+				}
+			} ) ;
+		}
+		/*
+		 * See future<T>::_launch()
+		 */
+		void _launch( void( future::*start )( std::size_t ) )
+		{
+			auto s = m_tasks.size() ;
+
+			if( m_max_in_flight > 0 && m_max_in_flight < s ){
+
+				s = m_max_in_flight ;
+			}
+
+			m_next = s ;
+
+			for( std::size_t i = 0 ; i < s ; i++ ){
+
+				( this->*start )( i ) ;
+			}
+		}
+		void _launch_next( void( future::*start )( std::size_t ) )
+		{
+			auto i = m_next.fetch_add( 1 ) ;
+
+			if( i < m_tasks.size() ){
+
+				( this->*start )( i ) ;
+			}
+		}
+
+		QThread * m_thread = nullptr ;
+
+		Task::detail::move_only_function< void() > m_function = [](){} ;
+		Task::detail::task< void > * m_task = nullptr ;
+		Task::detail::move_only_function< void() > m_when_any_function ;
+		Task::detail::move_only_function< void() > m_wait_function ;
+		Task::detail::object_guard m_context ;
+		bool m_inline = false ;
+		bool m_managed = false ;
+		bool m_serial = false ;
+		std::vector< std::pair< Task::future< void > *,Task::detail::move_only_function< void() > > > m_tasks ;
+		std::unique_ptr< bool[] > m_multiple ;
+		std::vector< QThread * > m_threads ;
+		QMutex m_mutex ;
+		std::atomic< decltype( m_tasks.size() ) > m_counter{ 0 } ;
+		std::atomic< std::size_t > m_next{ 0 } ;
+		std::size_t m_max_in_flight = 0 ;
+		std::atomic< bool > m_task_not_run{ true } ;
+	};
+
+	namespace detail
+	{
+		/*
+		 * -------------------------Start of internal helper functions-------------------------
+		 */
+		/*
+		 * Each of below classes holds everything a task needs,the function,its result and
+		 * the future,in a single object whose memory is recycled by Task::detail::recycler.
+		 */
+		template< typename Type,typename Function >
+		class ThreadHelper : public QThread,
+				     public Task::detail::task< Type >,
+				     public Task::detail::recyclable
+		{
+		public:
+			ThreadHelper( Function function ) :
+				m_function( std::move( function ) ),
+				m_future( this,this )
+			{
+				connect( this,&QThread::finished,this,&QThread::deleteLater ) ;
+			}
+			Task::future<Type>& Future()
+			{
+				return m_future ;
+			}
+		private:
+			~ThreadHelper()
+			{
+				if( m_delivery.pending() ){
+
+					m_future.run( std::move( m_result ) ) ;
+				}
+			}
+			void task_start() override
+			{
+				this->start() ;
+			}
+			void task_cancel() override
+			{
+				this->deleteLater() ;
+			}
+			Type task_get() override
+			{
+				this->deleteLater() ;
+				return m_function() ;
+			}
+			void task_run( Task::detail::move_only_function< void( Type ) > function ) override
+			{
+				m_run_function = std::move( function ) ;
+				this->start() ;
+			}
+			void run()
+			{
+				if( m_run_function ){
+
+					m_run_function( m_function() ) ;
+				}else{
+					m_result = m_function() ;
+
+					m_delivery.deliver( m_future,this,m_result ) ;
+				}
+			}
+			Function m_function ;
+			Task::future<Type> m_future ;
+			Type m_result ;
+			Task::detail::move_only_function< void( Type ) > m_run_function ;
+			Task::detail::delivery m_delivery ;
+		};
+
+		template< typename Function>
+		class ThreadHelperVoid : public QThread,
+					 public Task::detail::task< void >,
+					 public Task::detail::recyclable
+		{
+		public:
+			ThreadHelperVoid( Function function ) :
+				m_function( std::move( function ) ),
+				m_future( this,this )
+			{
+				connect( this,&QThread::finished,this,&QThread::deleteLater ) ;
+			}
+			Task::future< void >& Future()
+			{
+				return m_future ;
+			}
+		private:
+			~ThreadHelperVoid()
+			{
+				if( m_delivery.pending() ){
+
+					m_future.run() ;
+				}
+			}
+			void task_start() override
+			{
+				this->start() ;
+			}
+			void task_cancel() override
+			{
+				this->deleteLater() ;
+			}
+			void task_get() override
+			{
+				m_function() ;
+				this->deleteLater() ;
+			}
+			void task_run( Task::detail::move_only_function< void() > function ) override
+			{
+				m_run_function = std::move( function ) ;
+				this->start() ;
+			}
+			void run()
+			{
+				m_function() ;
+
+				if( m_run_function ){
+
+					m_run_function() ;
+				}else{
+					m_delivery.deliver( m_future,this ) ;
+				}
+			}
+			Function m_function ;
+			Task::future< void > m_future ;
+			Task::detail::move_only_function< void() > m_run_function ;
+			Task::detail::delivery m_delivery ;
+		};
+		template< typename Type,typename Function,typename Pool >
+		class RunnableHelper : public QObject,
+				       public QRunnable,
+				       public Task::detail::task< Type >,
+				       public Task::detail::recyclable
+		{
+		public:
+			RunnableHelper( Pool& pool,Function function ) :
+				m_pool( pool ),
+				m_function( std::move( function ) ),
+				m_future( nullptr,this )
+			{
+				this->setAutoDelete( false ) ;
+			}
+			Task::future<Type>& Future()
+			{
+				return m_future ;
+			}
+		private:
+			~RunnableHelper()
+			{
+				if( m_delivery.pending() ){
+
+					m_future.run( std::move( m_result ) ) ;
+				}
+			}
+			void task_start() override
+			{
+				this->launch() ;
+			}
+			void task_cancel() override
+			{
+				this->deleteLater() ;
+			}
+			Type task_get() override
+			{
+				this->deleteLater() ;
+				return m_function() ;
+			}
+			void task_run( Task::detail::move_only_function< void( Type ) > function ) override
+			{
+				m_run_function = std::move( function ) ;
+				this->launch() ;
+			}
+			void launch()
+			{
+				bool ran_inline = false ;
+
+				m_ran_inline = &ran_inline ;
+
+				m_pool.start( this ) ;
+
+				if( ran_inline ){
+
+					/*
+					 * Task::inline_executor ran us before start() returned and the
+					 * continuation runs from the destructor.
+					 */
+					delete this ;
+				}
+			}
+			void run() override
+			{
+				{
+					Task::detail::pool_thread< Pool > m ;
+
+					if( m_run_function ){
+
+						m_run_function( m_function() ) ;
+					}else{
+						m_result = m_function() ;
+					}
+				}
+
+				if( Task::inline_executor::running() == this ){
+
+					*m_ran_inline = true ;
+				}else{
+					if( !m_run_function ){
+
+						m_delivery.deliver( m_future,this,m_result ) ;
+					}
+
+					this->deleteLater() ;
+				}
+			}
+			Pool& m_pool ;
+			Function m_function ;
+			Task::future<Type> m_future ;
+			Type m_result ;
+			Task::detail::move_only_function< void( Type ) > m_run_function ;
+			Task::detail::delivery m_delivery ;
+			bool * m_ran_inline = nullptr ;
+		};
+
+		template< typename Function,typename Pool >
+		class RunnableHelperVoid : public QObject,
+					   public QRunnable,
+					   public Task::detail::task< void >,
+					   public Task::detail::recyclable
+		{
+		public:
+			RunnableHelperVoid( Pool& pool,Function function ) :
+				m_pool( pool ),
+				m_function( std::move( function ) ),
+				m_future( nullptr,this )
+			{
+				this->setAutoDelete( false ) ;
+			}
+			Task::future< void >& Future()
+			{
+				return m_future ;
+			}
+		private:
+			~RunnableHelperVoid()
+			{
+				if( m_delivery.pending() ){
+
+					m_future.run() ;
+				}
+			}
+			void task_start() override
+			{
+				this->launch() ;
+			}
+			void task_cancel() override
+			{
+				this->deleteLater() ;
+			}
+			void task_get() override
+			{
+				m_function() ;
+				this->deleteLater() ;
+			}
+			void task_run( Task::detail::move_only_function< void() > function ) override
+			{
+				m_run_function = std::move( function ) ;
+				this->launch() ;
+			}
+			/*
+			 * See RunnableHelper::launch()
+			 */
+			void launch()
+			{
+				bool ran_inline = false ;
+
+				m_ran_inline = &ran_inline ;
+
+				m_pool.start( this ) ;
+
+				if( ran_inline ){
+
+					delete this ;
+				}
+			}
+			void run() override
+			{
+				{
+					Task::detail::pool_thread< Pool > m ;
+
+					m_function() ;
+
+					if( m_run_function ){
+
+						m_run_function() ;
+					}
+				}
+
+				if( Task::inline_executor::running() == this ){
+
+					*m_ran_inline = true ;
+				}else{
+					if( !m_run_function ){
+
+						m_delivery.deliver( m_future,this ) ;
+					}
+
+					this->deleteLater() ;
+				}
+			}
+			Pool& m_pool ;
+			Function m_function ;
+			Task::future< void > m_future ;
+			Task::detail::move_only_function< void() > m_run_function ;
+			Task::detail::delivery m_delivery ;
+			bool * m_ran_inline = nullptr ;
+		};
+
+		inline Task::scheduler& current_scheduler()
+		{
+			auto s = Task::scheduler::current() ;
+
+			return s ? *s : Task::work_stealing_scheduler() ;
+		}
+		template<typename Fn,Task::detail::returns_value<Fn> = 0>
+		Task::future<Task::detail::result_of<Fn>>& run( Task::backend backend,Fn function )
+		{
+			using t = Task::detail::result_of<Fn> ;
+
+			if( backend == Task::backend::thread_pool ){
+
+				using e = RunnableHelper<t,Fn,QThreadPool> ;
+
+				return ( new e( Task::thread_pool(),std::move( function ) ) )->Future() ;
+
+			}else if( backend == Task::backend::work_stealing ){
+
+				using e = RunnableHelper<t,Fn,Task::scheduler> ;
+
+				return ( new e( Task::detail::current_scheduler(),std::move( function ) ) )->Future() ;
+			}else{
+				return ( new ThreadHelper<t,Fn>( std::move( function ) ) )->Future() ;
+			}
+		}
+		template<typename Fn,Task::detail::returns_void<Fn> = 0>
+		Task::future<Task::detail::result_of<Fn>>& run( Task::backend backend,Fn function )
+		{
+			if( backend == Task::backend::thread_pool ){
+
+				using e = RunnableHelperVoid<Fn,QThreadPool> ;
+
+				return ( new e( Task::thread_pool(),std::move( function ) ) )->Future() ;
+
+			}else if( backend == Task::backend::work_stealing ){
+
+				using e = RunnableHelperVoid<Fn,Task::scheduler> ;
+
+				return ( new e( Task::detail::current_scheduler(),std::move( function ) ) )->Future() ;
+			}else{
+				return ( new ThreadHelperVoid<Fn>( std::move( function ) ) )->Future() ;
+			}
+		}
+		template<typename Fn,Task::detail::returns_value<Fn> = 0>
+		Task::future<Task::detail::result_of<Fn>>& run( Task::executor& executor,Fn function )
+		{
+			using t = Task::detail::result_of<Fn> ;
+
+			return ( new RunnableHelper<t,Fn,Task::executor>( executor,std::move( function ) ) )->Future() ;
+		}
+		template<typename Fn,Task::detail::returns_void<Fn> = 0>
+		Task::future<Task::detail::result_of<Fn>>& run( Task::executor& executor,Fn function )
+		{
+			return ( new RunnableHelperVoid<Fn,Task::executor>( executor,std::move( function ) ) )->Future() ;
+		}
+		/*
+		 * Tasks created from a worker of a scheduler stay on that scheduler.
+		 */
+		inline Task::backend backend()
+		{
+			if( Task::scheduler::current() ){
+
+				return Task::backend::work_stealing ;
+			}else{
+				return Task::default_backend() ;
+			}
+		}
+		template<typename Fn>
+		Task::future<Task::detail::result_of<Fn>>& run( Fn function )
+		{
+			return Task::detail::run( Task::detail::backend(),std::move( function ) ) ;
+		}
+		template< typename T >
+		void add( Task::future< T >& a,Task::future< T >& b,Task::detail::move_only_function< void( T ) >&& c )
+		{
+			a.m_tasks.emplace_back( std::addressof( b ),std::move( c ) ) ;
+			a.m_threads.push_back( b.m_thread ) ;
+		}
+
+		template< typename T >
+		void add_void( Task::future< T >& a,Task::future< T >& b,Task::detail::move_only_function< T() >&& c )
+		{
+			a.m_tasks.emplace_back( std::addressof( b ),std::move( c ) ) ;
+			a.m_threads.push_back( b.m_thread ) ;
+		}
+
+		template< typename T,typename Where >
+		void add_task( Task::future< T >& f,Where& w )
+		{
+			Q_UNUSED( f )
+			Q_UNUSED( w )
+		}
+
+		template< typename T >
+		void add_future( Task::future< T >& f )
+		{
+			Q_UNUSED( f )
+		}
+
+		template< typename T >
+		void add_pair( Task::future< T >& f )
+		{
+			Q_UNUSED( f )
+		}
+
+		template< typename T >
+		void add_pair_void( Task::future< T >& f )
+		{
+			Q_UNUSED( f )
+		}
+
+		template< typename Where,typename Function,typename ... T >
+		void add_task( Task::future< void >& f,Where& w,Function e,T&& ... t )
+		{
+			add_void( f,Task::detail::run( w,[ e = std::move( e ) ]()mutable{ e() ; } ),
+				  Task::detail::move_only_function< void() >( [](){} ) ) ;
+			add_task( f,w,std::forward<T>( t ) ... ) ;
+		}
+
+		template< typename ... T >
+		void add_future( Task::future< void >& f,Task::future< void >& e,T&& ... t )
+		{
+			add_void( f,e,Task::detail::move_only_function< void() >( [](){} ) ) ;
+			add_future( f,std::forward<T>( t ) ... ) ;
+		}
+
+		template< typename E,typename F,typename ... T >
+		void add_pair( Task::future< E >& f,F&& s,T&& ... t )
+		{
+			add( f,Task::detail::run( std::move( s.value.first ) ),std::move( s.value.second ) ) ;
+			add_pair( f,std::forward<T>( t ) ... ) ;
+		}
+
+		template< typename F,typename ... T >
+		void add_pair_void( Task::future< void >& f,F&& s,T&& ... t )
+		{
+			add_void( f,Task::detail::run( std::move( s.value.first ) ),std::move( s.value.second ) ) ;
+			add_pair_void( f,std::forward<T>( t ) ... ) ;
+		}
+
+		template< typename T >
+		Task::future< T >& future()
+		{
+			return *( new Task::future< T >() ) ;
+		}
+
+		template< typename Where,typename Range >
+		Task::future< void >& run_tasks( Where& w,Range& r )
+		{
+			if( std::begin( r ) == std::end( r ) ){
+
+				/*
+				 * A future that manages no tasks never finishes,use one that finishes
+				 * right away so that its continuation runs.
+				 */
+				return Task::detail::run( w,[](){} ) ;
+			}
+
+			auto& e = Task::detail::future< void >() ;
+
+			for( auto& it : r ){
+
+				Task::detail::add_task( e,w,std::move( it ) ) ;
+			}
+
+			return e ;
+		}
+
+		template< typename T >
+		void add_future_reference( Task::future< T >& f,Task::future< T >& e )
+		{
+			add( f,e,Task::detail::move_only_function< void( T ) >( []( T ){} ) ) ;
+		}
+
+		inline void add_future_reference( Task::future< void >& f,Task::future< void >& e )
+		{
+			add_void( f,e,Task::detail::move_only_function< void() >( [](){} ) ) ;
+		}
+
+		template< typename T >
+		Task::future< T >& serial( Task::future< T >& e )
+		{
+			e.m_serial = true ;
+
+			return e ;
+		}
+
+	} //end of detail namespace
+
+
+	/*
+	 * -------------------------End of internal helper functions-------------------------
+	 */
+	template< typename Fn >
+	auto& run( Fn function )
+	{
+		return Task::detail::run( std::move( function ) ) ;
+	}
+	/*
+	 * Same as above but the task is powered by the given backend instead of
+	 * the one returned by Task::default_backend().
+	 */
+	template< typename Fn >
+	auto& run( Task::backend backend,Fn function )
+	{
+		return Task::detail::run( backend,std::move( function ) ) ;
+	}
+	/*
+	 * Same as above but the task is run by the given executor.
+	 */
+	template< typename Fn >
+	auto& run( Task::executor& executor,Fn function )
+	{
+		return Task::detail::run( executor,std::move( function ) ) ;
+	}
+#if __cplusplus > 201703L
+	template< typename Fn,typename ... Args >
+	future<std::invoke_result_t<Fn,Args...>>& run( Fn function,Args ... args )
+	{
+		return Task::run( [ function = std::move( function ),... args = std::move( args ) ]()mutable{
+
+			return function( std::move( args ) ... ) ;
+		} ) ;
+	}
+#elif __cplusplus == 201703L
+	template< typename Fn,typename ... Args >
+	future<std::invoke_result_t<Fn,Args...>>& run( Fn function,Args ... args )
+	{
+		return Task::run( [ args = std::make_tuple( std::move( args ) ... ),function = std::move( function ) ]()mutable{
+
+			return std::apply( [ function = std::move( function ) ]( Args ... args ){
+
+				return function( std::move( args ) ... ) ;
+
+			},std::move( args ) ) ;
+		} ) ;
+	}
+#else
+	template< typename Fn,typename ... Args >
+	future<std::result_of_t<Fn(Args...)>>& run( Fn function,Args ... args )
+	{
+		return Task::run( [ =,function = std::move( function ) ](){
+
+			return function( std::move( args ) ... ) ;
+		} ) ;
+	}
+#endif
+	class progress : public QObject{
+		Q_OBJECT
+	public:
+		template< typename function >
+		progress( QObject * obj,function fn )
+		{
+			connect( this,&progress::update,obj,std::move( fn ) ) ;
+		}
+	signals:
+		void update( QVariant x ) const ;
+	private:
+	};
+
+	template< typename Fn,typename cb >
+	future<Task::detail::result_of<Fn,const progress&>>& run( QObject * obj,Fn function,cb rp )
+	{
+		return Task::run( [ obj,rp = std::move( rp ),function = std::move( function ) ](){
+
+			return function( progress( obj,std::move( rp ) ) ) ;
+		} ) ;
+	}
+
+	namespace detail
+	{
+		/*
+		 * An unbounded queue with one producer and one consumer that takes no lock. Items are
+		 * stored in blocks of "block_size" and a block is only allocated when the last one is full.
+		 */
+		template< typename T >
+		class spsc_queue
+		{
+		public:
+			spsc_queue() : m_head( new block ),m_tail( m_head )
+			{
+			}
+			spsc_queue( const spsc_queue& ) = delete ;
+			spsc_queue& operator=( const spsc_queue& ) = delete ;
+			~spsc_queue()
+			{
+				this->consume( []( T ){} ) ;
+
+				delete m_head ;
+			}
+			/*
+			 * Called by the producer.
+			 */
+			void push( T e )
+			{
+				auto b = m_tail ;
+
+				auto n = b->written.load( std::memory_order_relaxed ) ;
+
+				if( n == block_size ){
+
+					auto s = new block ;
+
+					b->next.store( s,std::memory_order_release ) ;
+
+					m_tail = s ;
+
+					b = s ;
+
+					n = 0 ;
+				}
+
+				new ( &b->items[ n ] ) T( std::move( e ) ) ;
+
+				b->written.store( n + 1,std::memory_order_release ) ;
+			}
+			/*
+			 * Called by the consumer,passes every available item to "function" in the order
+			 * they were pushed.
+			 */
+			template< typename Function >
+			void consume( Function&& function )
+			{
+				while( true ){
+
+					auto b = m_head ;
+
+					if( b->read < b->written.load( std::memory_order_acquire ) ){
+
+						auto e = reinterpret_cast< T * >( &b->items[ b->read++ ] ) ;
+
+						T m = std::move( *e ) ;
+
+						e->~T() ;
+
+						function( std::move( m ) ) ;
+
+					}else if( b->read == block_size && b->next.load( std::memory_order_acquire ) ){
+
+						m_head = b->next.load( std::memory_order_relaxed ) ;
+
+						delete b ;
+					}else{
+						break ;
+					}
+				}
+			}
+		private:
+			static const std::size_t block_size = 64 ;
+
+			struct block
+			{
+				typename std::aligned_storage< sizeof( T ),alignof( T ) >::type items[ block_size ] ;
+				std::atomic< std::size_t > written{ 0 } ;
+				std::atomic< block * > next{ nullptr } ;
+				std::size_t read = 0 ;
+			};
+
+			block * m_head ;
+			char m_padding[ 64 ] ;
+			block * m_tail ;
+		};
+
+		template< typename T >
+		class progress_sink
+		{
+		public:
+			virtual void update( T ) = 0 ;
+			virtual ~progress_sink() = default ;
+		};
+
+		/*
+		 * Shared by a Task::typed_progress and the calls it posts to the receiver. Only one
+		 * call is posted at a time and it delivers everything that was queued before it ran.
+		 */
+		template< typename T >
+		class progress_channel : public Task::detail::progress_sink< T >,
+					 public std::enable_shared_from_this< progress_channel< T > >
+		{
+		public:
+			progress_channel( Task::detail::object_guard obj,Task::detail::move_only_function< void( T ) > function ) :
+				m_receiver( obj ),m_function( std::move( function ) )
+			{
+			}
+			void update( T e ) override
+			{
+				m_queue.push( std::move( e ) ) ;
+
+				std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+
+				if( !m_posted.exchange( true ) ){
+
+					m_receiver.post( [ s = this->shared_from_this() ](){
+
+						s->drain() ;
+					} ) ;
+				}
+			}
+		private:
+			void drain()
+			{
+				m_posted.store( false ) ;
+
+				std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+
+				m_queue.consume( [ this ]( T e ){
+
+					m_function( std::move( e ) ) ;
+				} ) ;
+			}
+			Task::detail::object_guard m_receiver ;
+			Task::detail::move_only_function< void( T ) > m_function ;
+			Task::detail::spsc_queue< T > m_queue ;
+			std::atomic< bool > m_posted{ false } ;
+		};
+
+		/*
+		 * Keeps only the latest value. The worker writes into a buffer of its own and swaps it
+		 * with the shared one and the receiver swaps the shared one with its own when it was
+		 * updated,a triple buffer that never blocks either side. At most one call or timer is
+		 * pending on the receiver's thread whatever the rate of updates is.
+		 */
+		template< typename T >
+		class progress_slot : public Task::detail::progress_sink< T >,
+				      public std::enable_shared_from_this< progress_slot< T > >
+		{
+		public:
+			progress_slot( QObject * obj,
+				       Task::detail::move_only_function< void( T ) > function,
+				       std::chrono::milliseconds interval ) :
+				m_receiver( obj ),m_function( std::move( function ) ),m_interval( interval )
+			{
+			}
+			void update( T e ) override
+			{
+				m_buffers[ m_back ] = std::move( e ) ;
+
+				m_back = m_middle.exchange( m_back | fresh,std::memory_order_acq_rel ) & mask ;
+
+				std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+
+				if( !m_posted.load( std::memory_order_relaxed ) && !m_posted.exchange( true ) ){
+
+					this->post() ;
+				}
+			}
+		private:
+			using clock = std::chrono::steady_clock ;
+
+			static const unsigned fresh = 4 ;
+			static const unsigned mask = 3 ;
+
+			void post()
+			{
+				m_receiver.post( [ s = this->shared_from_this() ](){
+
+					s->drain() ;
+				} ) ;
+			}
+			void drain()
+			{
+				auto now = clock::now() ;
+
+				if( m_delivered && now < m_last + m_interval ){
+
+					auto e = std::chrono::duration_cast< std::chrono::milliseconds >( m_last + m_interval - now ) ;
+
+					m_receiver.post( static_cast< int >( e.count() ) + 1,[ s = this->shared_from_this() ](){
+
+						s->drain() ;
+					} ) ;
+
+					return ;
+				}
+
+				m_posted.store( false ) ;
+
+				std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+
+				if( m_middle.load( std::memory_order_relaxed ) & fresh ){
+
+					m_front = m_middle.exchange( m_front,std::memory_order_acq_rel ) & mask ;
+
+					m_delivered = true ;
+
+					m_last = now ;
+
+					m_function( std::move( m_buffers[ m_front ] ) ) ;
+				}
+			}
+			Task::detail::object_guard m_receiver ;
+			Task::detail::move_only_function< void( T ) > m_function ;
+			std::chrono::milliseconds m_interval ;
+			T m_buffers[ 3 ] ;
+			unsigned m_back = 0 ;
+			char m_padding[ 64 ] ;
+			std::atomic< unsigned > m_middle{ 1 } ;
+			std::atomic< bool > m_posted{ false } ;
+			unsigned m_front = 2 ;
+			std::atomic< bool > m_delivered{ false } ;
+			clock::time_point m_last ;
+		};
+	}
+
+	/*
+	 * A typed alternative to Task::progress. Values are neither wrapped in a QVariant nor sent
+	 * through a signal,they are queued without a lock and the receiver gets them in one posted
+	 * call per batch,however many updates were made while the previous batch was delivered.
+	 *
+	 * A Task::typed_progress created with an interval only keeps the latest value,the receiver
+	 * gets it at most once per "interval" and values that were replaced before it got them are
+	 * dropped. An interval of 0 delivers the latest value once per pass of the receiver's event loop.
+	 * T must be default constructible in that mode.
+	 *
+	 * .update() must only be called by one thread at a time,the thread that runs the task. "obj"
+	 * must be alive when a Task::typed_progress is created and values are dropped once it is deleted.
+	 */
+	template< typename T >
+	class typed_progress
+	{
+	public:
+		template< typename Function >
+		typed_progress( QObject * obj,Function function ) :
+			m_sink( std::make_shared< Task::detail::progress_channel< T > >( obj,std::move( function ) ) )
+		{
+		}
+		/*
+		 * Used by Task::process::stream whose context objects are guarded from the thread
+		 * they were given on.
+		 */
+		template< typename Function >
+		typed_progress( Task::detail::object_guard obj,Function function ) :
+			m_sink( std::make_shared< Task::detail::progress_channel< T > >( std::move( obj ),std::move( function ) ) )
+		{
+		}
+		template< typename Function >
+		typed_progress( QObject * obj,Function function,std::chrono::milliseconds interval ) :
+			m_sink( std::make_shared< Task::detail::progress_slot< T > >( obj,std::move( function ),interval ) )
+		{
+		}
+		void update( T e ) const
+		{
+			m_sink->update( std::move( e ) ) ;
+		}
+	private:
+		std::shared_ptr< Task::detail::progress_sink< T > > m_sink ;
+	};
+
+	/*
+	 * Task::run< T >( obj,function,rp ) runs "function" with a Task::typed_progress< T > and
+	 * calls "rp( T )" on the thread of "obj" with every value given to its .update().
+	 */
+	template< typename T,typename Fn,typename cb >
+	future<Task::detail::result_of<Fn,const Task::typed_progress< T >&>>& run( QObject * obj,Fn function,cb rp )
+	{
+		Task::typed_progress< T > e( obj,std::move( rp ) ) ;
+
+		return Task::run( [ e = std::move( e ),function = std::move( function ) ]()mutable{
+
+			return function( e ) ;
+		} ) ;
+	}
+
+	/*
+	 * Like above but "rp" is called with the latest value at most once per "interval",see
+	 * Task::typed_progress.
+	 */
+	template< typename T,typename Fn,typename cb >
+	future<Task::detail::result_of<Fn,const Task::typed_progress< T >&>>& run( QObject * obj,
+										    Fn function,
+										    cb rp,
+										    std::chrono::milliseconds interval )
+	{
+		Task::typed_progress< T > e( obj,std::move( rp ),interval ) ;
+
+		return Task::run( [ e = std::move( e ),function = std::move( function ) ]()mutable{
+
+			return function( e ) ;
+		} ) ;
+	}
+
+	template< typename Function,typename ... T >
+	Task::future< void >& run_tasks( Task::backend b,Function f,T ... t )
+	{
+		auto& e = Task::detail::future< void >() ;
+		Task::detail::add_task( e,b,std::move( f ),std::move( t ) ... ) ;
+		return e ;
+	}
+	template< typename Function,typename ... T >
+	Task::future< void >& run_tasks( Task::executor& s,Function f,T ... t )
+	{
+		auto& e = Task::detail::future< void >() ;
+		Task::detail::add_task( e,s,std::move( f ),std::move( t ) ... ) ;
+		return e ;
+	}
+	/*
+	 * Tasks run one after another on a single worker of the strand and .queue() and
+	 * .when_seq() start all of them at once instead of starting each task after the
+	 * continuation of the previous one ran. Continuations still run in order.
+	 */
+	template< typename Function,typename ... T >
+	Task::future< void >& run_tasks( Task::strand& s,Function f,T ... t )
+	{
+		auto& e = Task::run_tasks( static_cast< Task::executor& >( s ),std::move( f ),std::move( t ) ... ) ;
+
+		return Task::detail::serial( e ) ;
+	}
+	template< typename Function,
+		  Task::detail::not_executor<Function> = 0,
+		  typename ... T >
+	Task::future< void >& run_tasks( Function f,T ... t )
+	{
+		return Task::run_tasks( Task::detail::backend(),std::move( f ),std::move( t ) ... ) ;
+	}
+
+	/*
+	 * Same as above but the tasks come from a range,like a std::vector,whose size is
+	 * only known at runtime.
+	 */
+	template< typename Range,Task::detail::range_of_callables<Range> = 0 >
+	Task::future< void >& run_tasks( Task::backend b,Range r )
+	{
+		return Task::detail::run_tasks( b,r ) ;
+	}
+	template< typename Range,Task::detail::range_of_callables<Range> = 0 >
+	Task::future< void >& run_tasks( Task::executor& s,Range r )
+	{
+		return Task::detail::run_tasks( s,r ) ;
+	}
+	template< typename Range,Task::detail::range_of_callables<Range> = 0 >
+	Task::future< void >& run_tasks( Task::strand& s,Range r )
+	{
+		return Task::detail::serial( Task::detail::run_tasks( s,r ) ) ;
+	}
+	template< typename Range,Task::detail::range_of_callables<Range> = 0 >
+	Task::future< void >& run_tasks( Range r )
+	{
+		auto b = Task::detail::backend() ;
+
+		return Task::detail::run_tasks( b,r ) ;
+	}
+	/*
+	 * Manage futures from a range whose elements are Task::future<T> * or
+	 * std::reference_wrapper< Task::future<T> >.
+	 */
+	template< typename Range,Task::detail::range_of_futures<Range> = 0 >
+	Task::future< Task::detail::range_future_type<Range> >& run_tasks( Range r )
+	{
+		using type = Task::detail::range_future_type<Range> ;
+		using reference = Task::detail::future_reference< Task::detail::range_value<Range> > ;
+
+		if( std::begin( r ) == std::end( r ) ){
+
+			return Task::detail::run( Task::detail::backend(),[](){ return type() ; } ) ;
+		}
+
+		auto& e = Task::detail::future< type >() ;
+
+		for( auto& it : r ){
+
+			Task::detail::add_future_reference( e,reference::get( it ) ) ;
+		}
+
+		return e ;
+	}
+	template< typename ... T >
+	Task::future< void >& run_tasks( Task::future< void >& s,T&& ... t )
+	{
+		auto& e = Task::detail::future< void >() ;
+		Task::detail::add_future( e,s,std::forward<T>( t ) ... ) ;
+		return e ;
+	}
+
+	template< typename ... T >
+	Task::future< void >& run( pair< void > s,T ... t )
+	{
+		auto& e = Task::detail::future< void >() ;
+		Task::detail::add_pair_void( e,std::move( s ),std::move( t ) ... ) ;
+		return e ;
+	}
+
+	template< typename E,typename ... T >
+	Task::future< E >& run( pair< E > s,T ... t )
+	{
+		auto& e = Task::detail::future< E >() ;
+		Task::detail::add_pair( e,std::move( s ),std::move( t ) ... ) ;
+		return e ;
+	}
+
+	template< typename E >
+	Task::future< E >& run( std::vector< pair< E > > s )
+	{
+		if( s.empty() ){
+
+			return Task::detail::run( Task::detail::backend(),[](){ return E() ; } ) ;
+		}
+
+		auto& e = Task::detail::future< E >() ;
+
+		for( auto& it : s ){
+
+			Task::detail::add_pair( e,std::move( it ) ) ;
+		}
+
+		return e ;
+	}
+	inline Task::future< void >& run( std::vector< pair< void > > s )
+	{
+		if( s.empty() ){
+
+			return Task::detail::run( Task::detail::backend(),[](){} ) ;
+		}
+
+		auto& e = Task::detail::future< void >() ;
+
+		for( auto& it : s ){
+
+			Task::detail::add_pair_void( e,std::move( it ) ) ;
+		}
+
+		return e ;
+	}
+
+	namespace detail
+	{
+		/*
+		 * Powers futures returned by Task::when_all(). Each managed future writes its result
+		 * into its own slot of a container that was sized up front on the thread that finished
+		 * it,completion is counted with an atomic counter and the collection is delivered like
+		 * the result of any other task.
+		 */
+		template< typename Results,typename Derived >
+		class collector : public QObject,
+				  public Task::detail::task< Results >,
+				  public Task::detail::recyclable
+		{
+		public:
+			collector( Results results,std::size_t size ) :
+				m_future( nullptr,this ),
+				m_results( std::move( results ) ),
+				m_size( size )
+			{
+			}
+			Task::future< Results >& Future()
+			{
+				return m_future ;
+			}
+		protected:
+			void task_start() override
+			{
+				static_cast< Derived * >( this )->start_all() ;
+			}
+			void task_cancel() override
+			{
+				static_cast< Derived * >( this )->cancel_all() ;
+
+				delete this ;
+			}
+			std::size_t max_in_flight() const
+			{
+				return m_future.m_max_in_flight ;
+			}
+			Results task_get() override
+			{
+				static_cast< Derived * >( this )->get_all() ;
+
+				auto m = std::move( m_results ) ;
+
+				delete this ;
+
+				return m ;
+			}
+			void task_run( Task::detail::move_only_function< void( Results ) > function ) override
+			{
+				m_run_function = std::move( function ) ;
+
+				static_cast< Derived * >( this )->start_all() ;
+			}
+			/*
+			 * Managed futures run concurrently and the calling thread is blocked until the
+			 * last one finishes,see future::wait() for threads of a pool.
+			 */
+			Results task_wait() override
+			{
+				if( Task::detail::on_bounded_pool() ){
+
+					return this->task_get() ;
+				}
+
+				Results m ;
+
+				QSemaphore s ;
+
+				this->task_run( [ &m,&s ]( Results e ){
+
+					m = std::move( e ) ;
+
+					s.release() ;
+				} ) ;
+
+				s.acquire() ;
+
+				return m ;
+			}
+			void finished()
+			{
+				if( m_counter.fetch_add( 1 ) + 1 == m_size ){
+
+					if( m_run_function ){
+
+						m_run_function( std::move( m_results ) ) ;
+					}else{
+						m_delivery.deliver( m_future,this,m_results ) ;
+					}
+
+					this->deleteLater() ;
+				}
+			}
+			~collector()
+			{
+				if( m_delivery.pending() ){
+
+					m_future.run( std::move( m_results ) ) ;
+				}
+			}
+
+			Task::future< Results > m_future ;
+			Results m_results ;
+		private:
+			std::size_t m_size ;
+			std::atomic< std::size_t > m_counter{ 0 } ;
+			Task::detail::move_only_function< void( Results ) > m_run_function ;
+			Task::detail::delivery m_delivery ;
+		};
+
+		template< typename T >
+		class vector_collector : public collector< std::vector< T >,vector_collector< T > >
+		{
+			static_assert( !std::is_void< T >::value,"Task::when_all() needs futures that have results" ) ;
+		public:
+			vector_collector( std::vector< Task::future< T > * > futures ) :
+				collector< std::vector< T >,vector_collector< T > >( std::vector< T >( futures.size() ),futures.size() ),
+				m_futures( std::move( futures ) )
+			{
+			}
+			void start_all()
+			{
+				auto s = m_futures.size() ;
+				auto m = this->max_in_flight() ;
+
+				if( m > 0 && m < s ){
+
+					s = m ;
+				}
+
+				m_next = s ;
+
+				for( std::size_t i = 0 ; i < s ; i++ ){
+
+					this->start( i ) ;
+				}
+			}
+			void cancel_all()
+			{
+				for( auto it : m_futures ){
+
+					it->cancel() ;
+				}
+			}
+			void get_all()
+			{
+				for( std::size_t i = 0 ; i < m_futures.size() ; i++ ){
+
+					this->m_results[ i ] = m_futures[ i ]->get() ;
+				}
+			}
+		private:
+			void start( std::size_t i )
+			{
+				m_futures[ i ]->then( Task::inline_continuation,[ this,i ]( T&& e ){
+
+					this->m_results[ i ] = std::move( e ) ;
+
+					auto next = m_next.fetch_add( 1 ) ;
+
+					if( next < m_futures.size() ){
+
+						this->start( next ) ;
+					}
+
+					this->finished() ;
+				} ) ;
+			}
+			std::vector< Task::future< T > * > m_futures ;
+			std::atomic< std::size_t > m_next{ 0 } ;
+		};
+
+		template< typename ... T >
+		class tuple_collector : public collector< std::tuple< T ... >,tuple_collector< T ... > >
+		{
+		public:
+			tuple_collector( Task::future< T >& ... futures ) :
+				collector< std::tuple< T ... >,tuple_collector< T ... > >( std::tuple< T ... >(),sizeof ... ( T ) ),
+				m_futures( std::addressof( futures ) ... )
+			{
+			}
+			void start_all()
+			{
+				this->start_all( std::index_sequence_for< T ... >() ) ;
+			}
+			void cancel_all()
+			{
+				this->cancel_all( std::index_sequence_for< T ... >() ) ;
+			}
+			void get_all()
+			{
+				this->get_all( std::index_sequence_for< T ... >() ) ;
+			}
+		private:
+			template< std::size_t ... I >
+			void start_all( std::index_sequence< I ... > )
+			{
+				int m[] = { ( this->start< I >(),0 ) ... } ;
+				Q_UNUSED( m )
+			}
+			template< std::size_t ... I >
+			void cancel_all( std::index_sequence< I ... > )
+			{
+				int m[] = { ( std::get< I >( m_futures )->cancel(),0 ) ... } ;
+				Q_UNUSED( m )
+			}
+			template< std::size_t ... I >
+			void get_all( std::index_sequence< I ... > )
+			{
+				int m[] = { ( std::get< I >( this->m_results ) = std::get< I >( m_futures )->get(),0 ) ... } ;
+				Q_UNUSED( m )
+			}
+			template< std::size_t I >
+			void start()
+			{
+				using type = std::tuple_element_t< I,std::tuple< T ... > > ;
+
+				static_assert( !std::is_void< type >::value,"Task::when_all() needs futures that have results" ) ;
+
+				std::get< I >( m_futures )->then( Task::inline_continuation,[ this ]( type&& e ){
+
+					std::get< I >( this->m_results ) = std::move( e ) ;
+
+					this->finished() ;
+				} ) ;
+			}
+			std::tuple< Task::future< T > * ... > m_futures ;
+		};
+
+		template< typename T,typename ... E >
+		struct all_same : std::true_type
+		{
+		};
+
+		template< typename T,typename F,typename ... E >
+		struct all_same< T,F,E ... > : std::integral_constant< bool,std::is_same< T,F >::value && all_same< T,E ... >::value >
+		{
+		};
+
+		template< typename T,typename ... E >
+		Task::future< std::vector< T > >& when_all( std::true_type,Task::future< T >& f,Task::future< E >& ... e )
+		{
+			std::vector< Task::future< T > * > m{ std::addressof( f ),std::addressof( e ) ... } ;
+
+			return ( new Task::detail::vector_collector< T >( std::move( m ) ) )->Future() ;
+		}
+
+		template< typename T,typename ... E >
+		Task::future< std::tuple< T,E ... > >& when_all( std::false_type,Task::future< T >& f,Task::future< E >& ... e )
+		{
+			return ( new Task::detail::tuple_collector< T,E ... >( f,e ... ) )->Future() ;
+		}
+	}
+
+	/*
+	 * Returns a future that manages the given futures and whose result is the collection of
+	 * their results,a std::vector<T> if all futures have the same type and a std::tuple<T...>
+	 * if they do not. Results are in the order the futures are given.
+	 */
+	template< typename T,typename ... E >
+	auto& when_all( Task::future< T >& f,Task::future< E >& ... e )
+	{
+		return Task::detail::when_all( Task::detail::all_same< T,E ... >(),f,e ... ) ;
+	}
+
+	/*
+	 * Same as above but the futures come from a range whose elements are Task::future<T> *
+	 * or std::reference_wrapper< Task::future<T> >. The result is always a std::vector<T>.
+	 */
+	template< typename Range,Task::detail::range_of_futures<Range> = 0 >
+	Task::future< std::vector< Task::detail::range_future_type<Range> > >& when_all( Range r )
+	{
+		using type = Task::detail::range_future_type<Range> ;
+		using reference = Task::detail::future_reference< Task::detail::range_value<Range> > ;
+
+		std::vector< Task::future< type > * > m ;
+
+		for( auto& it : r ){
+
+			m.emplace_back( std::addressof( reference::get( it ) ) ) ;
+		}
+
+		if( m.empty() ){
+
+			return Task::detail::run( Task::detail::backend(),[](){ return std::vector< type >() ; } ) ;
+		}
+
+		return ( new Task::detail::vector_collector< type >( std::move( m ) ) )->Future() ;
+	}
+
+	namespace detail
+	{
+		/*
+		 * Calls the function of a stage with the result of the previous stage.
+		 */
+		template< typename T >
+		struct stage_input
+		{
+			template< typename Function >
+			static auto get( Task::future< T >& f,Function& function )
+			{
+				return function( f.get() ) ;
+			}
+		};
+
+		template<>
+		struct stage_input< void >
+		{
+			template< typename Function >
+			static auto get( Task::future< void >& f,Function& function )
+			{
+				f.get() ;
+				return function() ;
+			}
+		};
+
+		/*
+		 * Powers futures returned by .next(). A stage runs its function on the worker of the
+		 * previous stage through its .task_run() and when a stage is itself followed by another
+		 * stage,it hands its result over on the same worker and nothing is posted in between.
+		 *
+		 * A future that manages other futures has no worker of its own and is waited on by
+		 * a task that the first stage follows.
+		 */
+		template< typename T,typename U,typename Function >
+		class stage : public QObject,
+			      public Task::detail::task< U >,
+			      public Task::detail::recyclable
+		{
+		public:
+			stage( Task::future< T >& f,Function function ) :
+				m_source( f ),
+				m_previous( &f ),
+				m_function( std::move( function ) ),
+				m_future( nullptr,this )
+			{
+				if( f.manages_multiple_futures() ){
+
+					m_previous = &Task::detail::run( [ &f ](){ return f.wait() ; } ) ;
+				}
+			}
+			Task::future< U >& Future()
+			{
+				return m_future ;
+			}
+		private:
+			void task_start() override
+			{
+				m_previous->_run( [ this ]( auto&& ... e ){
+
+					m_result = m_function( std::forward< decltype( e ) >( e ) ... ) ;
+
+					m_delivery.deliver( m_future,this,m_result ) ;
+
+					this->deleteLater() ;
+				} ) ;
+			}
+			void task_cancel() override
+			{
+				m_previous->cancel() ;
+
+				if( m_previous != &m_source ){
+
+					m_source.cancel() ;
+				}
+
+				this->deleteLater() ;
+			}
+			U task_get() override
+			{
+				this->deleteLater() ;
+
+				return Task::detail::stage_input< T >::get( *m_previous,m_function ) ;
+			}
+			void task_run( Task::detail::move_only_function< void( U ) > function ) override
+			{
+				m_previous->_run( [ this,function = std::move( function ) ]( auto&& ... e )mutable{
+
+					function( m_function( std::forward< decltype( e ) >( e ) ... ) ) ;
+
+					this->deleteLater() ;
+				} ) ;
+			}
+			Task::future< T >& m_source ;
+			Task::future< T > * m_previous ;
+			Function m_function ;
+			Task::future< U > m_future ;
+			U m_result ;
+			Task::detail::delivery m_delivery ;
+		};
+
+		template< typename T,typename Function >
+		class stage< T,void,Function > : public QObject,
+						 public Task::detail::task< void >,
+						 public Task::detail::recyclable
+		{
+		public:
+			stage( Task::future< T >& f,Function function ) :
+				m_source( f ),
+				m_previous( &f ),
+				m_function( std::move( function ) ),
+				m_future( nullptr,this )
+			{
+				if( f.manages_multiple_futures() ){
+
+					m_previous = &Task::detail::run( [ &f ](){ return f.wait() ; } ) ;
+				}
+			}
+			Task::future< void >& Future()
+			{
+				return m_future ;
+			}
+		private:
+			void task_start() override
+			{
+				m_previous->_run( [ this ]( auto&& ... e ){
+
+					m_function( std::forward< decltype( e ) >( e ) ... ) ;
+
+					m_delivery.deliver( m_future,this ) ;
+
+					this->deleteLater() ;
+				} ) ;
+			}
+			void task_cancel() override
+			{
+				m_previous->cancel() ;
+
+				if( m_previous != &m_source ){
+
+					m_source.cancel() ;
+				}
+
+				this->deleteLater() ;
+			}
+			void task_get() override
+			{
+				this->deleteLater() ;
+
+				Task::detail::stage_input< T >::get( *m_previous,m_function ) ;
+			}
+			void task_run( Task::detail::move_only_function< void() > function ) override
+			{
+				m_previous->_run( [ this,function = std::move( function ) ]( auto&& ... e )mutable{
+
+					m_function( std::forward< decltype( e ) >( e ) ... ) ;
+
+					function() ;
+
+					this->deleteLater() ;
+				} ) ;
+			}
+			Task::future< T >& m_source ;
+			Task::future< T > * m_previous ;
+			Function m_function ;
+			Task::future< void > m_future ;
+			Task::detail::delivery m_delivery ;
+		};
+
+		template< typename Function,typename T >
+		Task::future< Task::detail::result_of< Function,T > >& next( Task::future< T >& f,Function function )
+		{
+			using type = Task::detail::result_of< Function,T > ;
+
+			return ( new Task::detail::stage< T,type,Function >( f,std::move( function ) ) )->Future() ;
+		}
+
+		template< typename Function >
+		Task::future< Task::detail::result_of< Function > >& next( Task::future< void >& f,Function function )
+		{
+			using type = Task::detail::result_of< Function > ;
+
+			return ( new Task::detail::stage< void,type,Function >( f,std::move( function ) ) )->Future() ;
+		}
+	}
+
+	/*
+	 *
+	 * A few useful helper functions
+	 *
+	 */
+	template< typename Fn >
+	Task::detail::result_of<Fn> await( Fn function )
+	{
+		return Task::run( std::move( function ) ).await() ;
+	}
+
+	template< typename Fn,typename ... Args >
+	Task::detail::result_of<Fn,Args ...> await( Fn function,Args ... args )
+	{
+		return Task::run( std::move( function ),std::move( args ) ... ).await() ;
+	}
+	template< typename T >
+	T await( Task::future<T>& e )
+	{
+		return e.await() ;
+	}
+
+	template< typename T >
+	T await( std::future<T> t )
+	{
+		return Task::await<T>( [ & ](){ return t.get() ; } ) ;
+	}
+
+	/*
+	 * These methods run their arguments in a separate thread and does not offer
+	 * continuation feature.Useful when wanting to just run a function in a
+	 * different thread.
+	 */
+	template< typename Fn >
+	void exec( Fn function )
+	{
+		Task::run( std::move( function ) ).start() ;
+	}
+	template< typename Fn >
+	void exec( Task::backend backend,Fn function )
+	{
+		Task::run( backend,std::move( function ) ).start() ;
+	}
+	template< typename Fn >
+	void exec( Task::executor& executor,Fn function )
+	{
+		Task::run( executor,std::move( function ) ).start() ;
+	}
+	template< typename Fn,Task::detail::not_executor<Fn> = 0,typename ... Args >
+	void exec( Fn function,Args ... args )
+	{
+		Task::run( std::move( function ),std::move( args ) ... ).start() ;
+	}
+	template< typename T >
+	void exec( Task::future<T>& e )
+	{
+		e.start() ;
+	}
+
+	namespace detail
+	{
+		/*
+		 * Splits "size" elements into chunks for Task::parallel_for() and
+		 * Task::parallel_transform().
+		 *
+		 * A chunk is at least a cache line worth of elements and at most "cache_size" bytes
+		 * of them and there are several chunks per worker so that workers that finish early
+		 * can take more. Chunk boundaries fall on cache line boundaries of the elements at
+		 * "base" so that two workers never write to the same cache line.
+		 *
+		 * Indexes are split with an element size of 1 and no "base",chunks are then multiples
+		 * of "cache_line" indexes and their boundaries say nothing about the memory a worker
+		 * writes to.
+		 */
+		class chunks
+		{
+		public:
+			static const std::size_t cache_line = 64 ;
+			static const std::size_t cache_size = 32 * 1024 ;
+			static const std::size_t chunks_per_worker = 8 ;
+
+			chunks( std::size_t size,std::size_t element_size,const void * base,std::size_t workers ) :
+				m_size( size )
+			{
+				std::size_t line = 1 ;
+
+				if( element_size < cache_line && cache_line % element_size == 0 ){
+
+					line = cache_line / element_size ;
+
+					auto offset = reinterpret_cast< std::uintptr_t >( base ) % cache_line ;
+
+					if( offset % element_size == 0 ){
+
+						m_head = ( ( cache_line - offset ) % cache_line ) / element_size ;
+					}
+				}
+
+				auto most = cache_size / element_size ;
+
+				m_chunk = size / ( ( workers < 1 ? 1 : workers ) * chunks_per_worker ) ;
+
+				if( m_chunk > most ){
+
+					m_chunk = most ;
+				}
+
+				m_chunk = ( m_chunk + line - 1 ) / line * line ;
+
+				if( m_chunk < line ){
+
+					m_chunk = line ;
+				}
+
+				if( m_head >= size ){
+
+					m_head = 0 ;
+				}
+
+				m_count = ( size - m_head + m_chunk - 1 ) / m_chunk ;
+
+				if( m_count < 1 ){
+
+					m_count = 1 ;
+				}
+
+				m_workers = workers < m_count ? workers : m_count ;
+
+				if( m_workers < 1 ){
+
+					m_workers = 1 ;
+				}
+			}
+			/*
+			 * The number of threads that take chunks.
+			 */
+			std::size_t workers() const
+			{
+				return m_workers ;
+			}
+			std::size_t count() const
+			{
+				return m_count ;
+			}
+			std::size_t begin( std::size_t chunk ) const
+			{
+				return chunk == 0 ? 0 : m_head + chunk * m_chunk ;
+			}
+			std::size_t end( std::size_t chunk ) const
+			{
+				auto e = m_head + ( chunk + 1 ) * m_chunk ;
+
+				return e < m_size ? e : m_size ;
+			}
+		private:
+			std::size_t m_size ;
+			std::size_t m_head = 0 ;
+			std::size_t m_chunk = 1 ;
+			std::size_t m_count = 1 ;
+			std::size_t m_workers = 1 ;
+		};
+
+		/*
+		 * Runs "function( worker,begin,end )" for every chunk on the calling thread,worker 0,
+		 * and on up to "chunks.workers() - 1" helpers started on Task::thread_pool() and returns
+		 * when all chunks are done. Helpers only wait for chunks they took and those that start
+		 * after all chunks were taken return right away,a call never waits for a helper to get
+		 * a thread and nested calls therefore can not deadlock.
+		 */
+		template< typename Function >
+		void parallel( const Task::detail::chunks& chunks,Function function )
+		{
+			class state
+			{
+			public:
+				state( const Task::detail::chunks& c,Function& f ) :
+					m_chunks( c ),m_function( f )
+				{
+				}
+				void work( std::size_t worker )
+				{
+					while( true ){
+
+						auto i = m_next.fetch_add( 1 ) ;
+
+						if( i >= m_chunks.count() ){
+
+							break ;
+						}
+
+						m_function( worker,m_chunks.begin( i ),m_chunks.end( i ) ) ;
+
+						m_done.release() ;
+					}
+				}
+				void wait()
+				{
+					m_done.acquire( static_cast< int >( m_chunks.count() ) ) ;
+				}
+			private:
+				Task::detail::chunks m_chunks ;
+				Function& m_function ;
+				std::atomic< std::size_t > m_next{ 0 } ;
+				QSemaphore m_done ;
+			} ;
+
+			class helper : public QRunnable
+			{
+			public:
+				helper( std::shared_ptr< state > s,std::size_t worker ) :
+					m_state( std::move( s ) ),m_worker( worker )
+				{
+				}
+				void run() override
+				{
+					m_state->work( m_worker ) ;
+				}
+			private:
+				std::shared_ptr< state > m_state ;
+				std::size_t m_worker ;
+			} ;
+
+			auto s = std::make_shared< state >( chunks,function ) ;
+
+			for( std::size_t i = 1 ; i < chunks.workers() ; i++ ){
+
+				Task::thread_pool().start( new helper( s,i ) ) ;
+			}
+
+			s->work( 0 ) ;
+
+			s->wait() ;
+		}
+
+		inline std::size_t workers()
+		{
+			return static_cast< std::size_t >( Task::thread_pool().maxThreadCount() ) ;
+		}
+
+		/*
+		 * A container whose elements are stored contiguously and that has .data() and .size(),
+		 * like a std::vector or a QVector.
+		 */
+		template< typename Container,typename = void >
+		struct is_contiguous : std::false_type
+		{
+		};
+
+		template< typename Container >
+		struct is_contiguous< Container,decltype( void( std::declval< Container& >().data() ),
+							  void( std::declval< Container& >().size() ) ) > :
+			std::is_pointer< decltype( std::declval< Container& >().data() ) >
+		{
+		};
+
+		template< typename Container >
+		using container = std::enable_if_t< Task::detail::is_contiguous< Container >::value,int > ;
+
+		template< typename First,typename Last >
+		using indexes = std::enable_if_t< std::is_integral< First >::value && std::is_integral< Last >::value,int > ;
+
+		/*
+		 * A negative "first" would turn into a huge index in the common type of a signed
+		 * and an unsigned end.
+		 */
+		template< typename First,typename Last >
+		constexpr bool same_signedness()
+		{
+			return std::is_signed< First >::value == std::is_signed< Last >::value ;
+		}
+	}
+
+	/*
+	 * Calls "function( i )" for every i in [ first,last ) on the threads of Task::thread_pool()
+	 * and the calling thread and returns when all calls are done. Indexes are split in chunks
+	 * of a multiple of 64 indexes and a chunk is run by one thread. Unlike with containers,chunk
+	 * boundaries do not keep the writes of "function" to different cache lines.
+	 *
+	 * "first" and "last" must both be signed or both be unsigned,use "0u" with a .size(),they
+	 * are converted to their common type and "i" has that type.
+	 */
+	template< typename First,typename Last,typename Function,Task::detail::indexes< First,Last > = 0 >
+	void parallel_for( First b,Last l,Function function )
+	{
+		static_assert( Task::detail::same_signedness< First,Last >(),"Task::parallel_for() needs two signed or two unsigned ends" ) ;
+
+		using Index = std::common_type_t< First,Last > ;
+
+		auto first = static_cast< Index >( b ) ;
+		auto last = static_cast< Index >( l ) ;
+
+		if( last <= first ){
+
+			return ;
+		}
+
+		auto size = static_cast< std::size_t >( last - first ) ;
+
+		Task::detail::chunks chunks( size,1,nullptr,Task::detail::workers() ) ;
+
+		Task::detail::parallel( chunks,[ first,&function ]( std::size_t,std::size_t b,std::size_t e ){
+
+			for( auto i = b ; i < e ; i++ ){
+
+				function( static_cast< Index >( first + static_cast< Index >( i ) ) ) ;
+			}
+		} ) ;
+	}
+
+	/*
+	 * Same as above but "function( element )" is called for every element of a container whose
+	 * elements are stored contiguously,like a std::vector or a QVector. Chunk boundaries fall on
+	 * cache line boundaries of the elements.
+	 */
+	template< typename Container,typename Function,Task::detail::container< Container > = 0 >
+	void parallel_for( Container& c,Function function )
+	{
+		auto size = static_cast< std::size_t >( c.size() ) ;
+
+		if( size == 0 ){
+
+			return ;
+		}
+
+		auto first = c.data() ;
+
+		Task::detail::chunks chunks( size,sizeof( *first ),first,Task::detail::workers() ) ;
+
+		Task::detail::parallel( chunks,[ first,&function ]( std::size_t,std::size_t b,std::size_t e ){
+
+			for( auto i = b ; i < e ; i++ ){
+
+				function( first[ i ] ) ;
+			}
+		} ) ;
+	}
+
+	/*
+	 * Returns a std::vector with the results of "function( element )" for every element of a
+	 * container whose elements are stored contiguously. Every thread writes its results
+	 * straight into their slots and chunk boundaries fall on cache line boundaries of the results.
+	 *
+	 * "function" can not return a bool because std::vector< bool > packs its elements into bits
+	 * and threads writing to neighbouring elements would write to the same byte.
+	 */
+	template< typename Container,typename Function,Task::detail::container< const Container > = 0 >
+	auto parallel_transform( const Container& c,Function function )
+	{
+		using type = std::decay_t< decltype( function( *c.data() ) ) > ;
+
+		static_assert( !std::is_same< type,bool >::value,"Task::parallel_transform() can not return a std::vector< bool >,return a char instead" ) ;
+
+		auto first = c.data() ;
+
+		auto size = static_cast< std::size_t >( c.size() ) ;
+
+		std::vector< type > m( size ) ;
+
+		if( size == 0 ){
+
+			return m ;
+		}
+
+		Task::detail::chunks chunks( size,sizeof( type ),m.data(),Task::detail::workers() ) ;
+
+		Task::detail::parallel( chunks,[ first,&function,&m ]( std::size_t,std::size_t b,std::size_t e ){
+
+			for( auto i = b ; i < e ; i++ ){
+
+				m[ i ] = function( first[ i ] ) ;
+			}
+		} ) ;
+
+		return m ;
+	}
+
+	/*
+	 * Same as the functions above but they return a future and the work is started when
+	 * .then(),.await(),.get() or co_await is called on it. The range must outlive the future.
+	 *
+	 * The work is started on a thread of Task::thread_pool() that stays blocked until all
+	 * chunks are done,the other threads of the pool and that thread run the chunks.
+	 */
+	template< typename First,typename Last,typename Function,Task::detail::indexes< First,Last > = 0 >
+	Task::future< void >& run_parallel_for( First first,Last last,Function function )
+	{
+		static_assert( Task::detail::same_signedness< First,Last >(),"Task::run_parallel_for() needs two signed or two unsigned ends" ) ;
+
+		return Task::run( Task::backend::thread_pool,[ first,last,function = std::move( function ) ]()mutable{
+
+			Task::parallel_for( first,last,std::move( function ) ) ;
+		} ) ;
+	}
+
+	template< typename Container,typename Function,Task::detail::container< Container > = 0 >
+	Task::future< void >& run_parallel_for( Container& c,Function function )
+	{
+		return Task::run( Task::backend::thread_pool,[ &c,function = std::move( function ) ]()mutable{
+
+			Task::parallel_for( c,std::move( function ) ) ;
+		} ) ;
+	}
+
+	template< typename Container,typename Function,Task::detail::container< const Container > = 0 >
+	auto& run_parallel_transform( const Container& c,Function function )
+	{
+		return Task::run( Task::backend::thread_pool,[ &c,function = std::move( function ) ]()mutable{
+
+			return Task::parallel_transform( c,std::move( function ) ) ;
+		} ) ;
+	}
+
+	namespace detail
+	{
+		/*
+		 * A partial result of Task::parallel_reduce(),the padding keeps partials of different
+		 * workers out of each other's cache lines.
+		 */
+		template< typename T >
+		struct partial
+		{
+			T value ;
+			char padding[ Task::detail::chunks::cache_line ] ;
+		};
+
+		/*
+		 * "map( partial,element )" updates the partial in place and "map( element )" returns
+		 * a value that is combined into the partial.
+		 */
+		template< typename T,typename Map,typename Combine,typename E >
+		auto accumulate( T& partial,Map& map,Combine&,E&& e,int ) -> decltype( void( map( partial,std::forward< E >( e ) ) ) )
+		{
+			map( partial,std::forward< E >( e ) ) ;
+		}
+
+		template< typename T,typename Map,typename Combine,typename E >
+		void accumulate( T& partial,Map& map,Combine& combine,E&& e,long )
+		{
+			partial = combine( std::move( partial ),map( std::forward< E >( e ) ) ) ;
+		}
+
+		template< typename T,typename Get,typename Map,typename Combine >
+		T reduce( std::size_t size,std::size_t element_size,Get get,T identity,Map& map,Combine& combine )
+		{
+			if( size == 0 ){
+
+				return identity ;
+			}
+
+			Task::detail::chunks chunks( size,element_size,nullptr,Task::detail::workers() ) ;
+
+			std::vector< Task::detail::partial< T > > partials( chunks.workers(),Task::detail::partial< T >{ identity,{} } ) ;
+
+			Task::detail::parallel( chunks,[ & ]( std::size_t worker,std::size_t b,std::size_t e ){
+
+				auto& partial = partials[ worker ].value ;
+
+				for( auto i = b ; i < e ; i++ ){
+
+					Task::detail::accumulate( partial,map,combine,get( i ),0 ) ;
+				}
+			} ) ;
+
+			/*
+			 * Partials are combined in pairs,then pairs of pairs and so on.
+			 */
+			for( std::size_t step = 1 ; step < partials.size() ; step *= 2 ){
+
+				for( std::size_t i = 0 ; i + step < partials.size() ; i += 2 * step ){
+
+					auto& a = partials[ i ].value ;
+					auto& b = partials[ i + step ].value ;
+
+					a = combine( std::move( a ),std::move( b ) ) ;
+				}
+			}
+
+			return std::move( partials[ 0 ].value ) ;
+		}
+	}
+
+	/*
+	 * Returns a future whose result is "identity" combined with "map( element )" of every element
+	 * of a container whose elements are stored contiguously. "map" can also take the partial result
+	 * by reference and an element and update the partial in place.
+	 *
+	 * Every thread accumulates into a partial result of its own and partials are combined with
+	 * "combine( T,T )" in a tree after all elements were visited,"combine" must be associative
+	 * and commutative because a thread takes chunks from anywhere in the container and
+	 * "identity" must not change a value it is combined with. The container must outlive
+	 * the future.
+	 */
+	template< typename Container,typename T,typename Map,typename Combine,
+		  Task::detail::container< Container > = 0 >
+	Task::future< T >& parallel_reduce( const Container& c,T identity,Map map,Combine combine )
+	{
+		auto e = [ &c,identity = std::move( identity ),map = std::move( map ),combine = std::move( combine ) ]()mutable{
+
+			auto first = c.data() ;
+
+			auto size = static_cast< std::size_t >( c.size() ) ;
+
+			auto get = [ first ]( std::size_t i ) -> decltype( *first ){
+
+				return first[ i ] ;
+			} ;
+
+			return Task::detail::reduce( size,sizeof( *first ),get,identity,map,combine ) ;
+		} ;
+
+		return Task::run( Task::backend::thread_pool,std::move( e ) ) ;
+	}
+
+	/*
+	 * Same as above but "map" is called with every index in [ first,last ),"first" and "last"
+	 * must both be signed or both be unsigned and are converted to their common type.
+	 */
+	template< typename First,typename Last,typename T,typename Map,typename Combine,
+		  Task::detail::indexes< First,Last > = 0 >
+	Task::future< T >& parallel_reduce( First b,Last l,T identity,Map map,Combine combine )
+	{
+		static_assert( Task::detail::same_signedness< First,Last >(),"Task::parallel_reduce() needs two signed or two unsigned ends" ) ;
+
+		using Index = std::common_type_t< First,Last > ;
+
+		auto first = static_cast< Index >( b ) ;
+		auto last = static_cast< Index >( l ) ;
+
+		auto e = [ first,last,identity = std::move( identity ),map = std::move( map ),combine = std::move( combine ) ]()mutable{
+
+			auto size = last > first ? static_cast< std::size_t >( last - first ) : 0 ;
+
+			auto get = [ first ]( std::size_t i ){
+
+				return static_cast< Index >( first + static_cast< Index >( i ) ) ;
+			} ;
+
+			return Task::detail::reduce( size,1,get,identity,map,combine ) ;
+		} ;
+
+		return Task::run( Task::backend::thread_pool,std::move( e ) ) ;
+	}
+
+	namespace detail
+	{
+		/*
+		 * Shared by a Task::forked and the task that runs its function.
+		 */
+		class fork_state_base
+		{
+		public:
+			virtual ~fork_state_base() = default ;
+			bool done() const
+			{
+				return m_done.load( std::memory_order_acquire ) ;
+			}
+			/*
+			 * Runs the function unless it already started. The task started on the
+			 * scheduler and a thread that joins without being one of its workers
+			 * race for it and the function runs once.
+			 */
+			void execute()
+			{
+				if( !m_claimed.exchange( true,std::memory_order_acq_rel ) ){
+
+					this->call() ;
+				}
+			}
+			void wait( unsigned long ms )
+			{
+				QMutexLocker m( &m_mutex ) ;
+
+				if( !this->done() ){
+
+					m_wait.wait( &m_mutex,ms ) ;
+				}
+			}
+			void wait()
+			{
+				QMutexLocker m( &m_mutex ) ;
+
+				while( !this->done() ){
+
+					m_wait.wait( &m_mutex ) ;
+				}
+			}
+		protected:
+			virtual void call() = 0 ;
+			void finish()
+			{
+				QMutexLocker m( &m_mutex ) ;
+
+				m_done.store( true,std::memory_order_release ) ;
+
+				m_wait.wakeAll() ;
+			}
+			void rethrow()
+			{
+				if( m_exception ){
+
+					std::rethrow_exception( m_exception ) ;
+				}
+			}
+			std::exception_ptr m_exception ;
+		private:
+			std::atomic< bool > m_claimed{ false } ;
+			std::atomic< bool > m_done{ false } ;
+			QMutex m_mutex ;
+			QWaitCondition m_wait ;
+		};
+
+		template< typename T >
+		class fork_state : public Task::detail::fork_state_base
+		{
+		public:
+			template< typename Function >
+			void run( Function& function )
+			{
+				try{
+					m_result.reset( new T( function() ) ) ;
+
+				}catch( ... ){
+
+					this->m_exception = std::current_exception() ;
+				}
+
+				this->finish() ;
+			}
+			T get()
+			{
+				this->rethrow() ;
+
+				return std::move( *m_result ) ;
+			}
+		private:
+			std::unique_ptr< T > m_result ;
+		};
+
+		template<>
+		class fork_state< void > : public Task::detail::fork_state_base
+		{
+		public:
+			template< typename Function >
+			void run( Function& function )
+			{
+				try{
+					function() ;
+
+				}catch( ... ){
+
+					this->m_exception = std::current_exception() ;
+				}
+
+				this->finish() ;
+			}
+			void get()
+			{
+				this->rethrow() ;
+			}
+		};
+
+		template< typename T,typename Function >
+		class fork_function : public Task::detail::fork_state< T >
+		{
+		public:
+			fork_function( Function function ) : m_function( std::move( function ) )
+			{
+			}
+		private:
+			void call() override
+			{
+				this->run( m_function ) ;
+			}
+			Function m_function ;
+		};
+
+		class fork_task : public QRunnable
+		{
+		public:
+			fork_task( std::shared_ptr< Task::detail::fork_state_base > s ) :
+				m_state( std::move( s ) )
+			{
+			}
+			void run() override
+			{
+				m_state->execute() ;
+			}
+		private:
+			std::shared_ptr< Task::detail::fork_state_base > m_state ;
+		};
+	}
+
+	/*
+	 * A function started with Task::fork(). .join() returns its result and while it waits,
+	 * a worker of the scheduler runs other pending tasks of the scheduler,starting with the
+	 * ones it forked last,and it therefore usually runs the forked function itself if no other
+	 * worker took it. Recursive fork/join uses no more threads than the scheduler has.
+	 *
+	 * Any other thread runs the forked function itself if no worker took it yet and otherwise
+	 * blocks until it finished,it never runs other tasks of the scheduler.
+	 *
+	 * An exception thrown by the forked function is thrown again by .join(). .join() can be
+	 * called once,calling it again throws std::future_error with std::future_errc::no_state.
+	 *
+	 * A forked function that was not joined is joined by the destructor and an exception it
+	 * threw is dropped.
+	 */
+	template< typename T >
+	class forked
+	{
+	public:
+		forked( Task::scheduler& s,std::shared_ptr< Task::detail::fork_state< T > > e ) :
+			m_scheduler( &s ),m_state( std::move( e ) )
+		{
+		}
+		forked( forked&& ) = default ;
+		forked& operator=( forked&& ) = default ;
+		forked( const forked& ) = delete ;
+		forked& operator=( const forked& ) = delete ;
+		~forked()
+		{
+			if( m_state ){
+
+				try{
+					this->join() ;
+
+				}catch( ... ){
+				}
+			}
+		}
+		T join()
+		{
+			if( !m_state ){
+
+				throw std::future_error( std::future_errc::no_state ) ;
+			}
+
+			auto s = std::move( m_state ) ;
+
+			if( Task::scheduler::current() != m_scheduler ){
+
+				s->execute() ;
+
+				s->wait() ;
+
+				return s->get() ;
+			}
+
+			int idle = 0 ;
+
+			while( !s->done() ){
+
+				if( m_scheduler->run_pending() ){
+
+					idle = 0 ;
+
+				}else if( ++idle < 64 ){
+
+					QThread::yieldCurrentThread() ;
+				}else{
+					/*
+					 * Our function runs on another thread,check for work to steal
+					 * from time to time while waiting for it.
+					 */
+					s->wait( 1 ) ;
+				}
+			}
+
+			return s->get() ;
+		}
+	private:
+		Task::scheduler * m_scheduler ;
+		std::shared_ptr< Task::detail::fork_state< T > > m_state ;
+	};
+
+	/*
+	 * Starts a function on a scheduler and returns a Task::forked whose .join() returns
+	 * its result.
+	 */
+	template< typename Function >
+	Task::forked< Task::detail::result_of< Function > > fork( Task::scheduler& s,Function function )
+	{
+		using type = Task::detail::result_of< Function > ;
+
+		using state = Task::detail::fork_function< type,Function > ;
+
+		std::shared_ptr< Task::detail::fork_state< type > > e = std::make_shared< state >( std::move( function ) ) ;
+
+		s.start( new Task::detail::fork_task( e ) ) ;
+
+		return Task::forked< type >( s,std::move( e ) ) ;
+	}
+
+	/*
+	 * Same as above but the function runs on the scheduler that runs the current task or on
+	 * Task::work_stealing_scheduler() if the current thread is not one of its workers.
+	 */
+	template< typename Function >
+	Task::forked< Task::detail::result_of< Function > > fork( Function function )
+	{
+		auto s = Task::scheduler::current() ;
+
+		return Task::fork( s ? *s : Task::work_stealing_scheduler(),std::move( function ) ) ;
+	}
+
+	namespace detail
+	{
+		class graph_runner ;
+	}
+
+	/*
+	 * A set of functions with dependencies between them. A node starts as soon as all nodes
+	 * it depends on finished and nodes that do not depend on each other run in parallel.
+	 *
+	 * .run() hands the nodes over to the returned future and the graph is empty afterwards.
+	 * The result of the future reports how long the longest chain of dependent nodes took.
+	 */
+	class graph
+	{
+	public:
+		struct node
+		{
+			std::size_t id ;
+		};
+
+		struct report
+		{
+			/*
+			 * The longest chain of dependent nodes,measured by how long their functions ran.
+			 */
+			std::chrono::nanoseconds critical_path{ 0 } ;
+			/*
+			 * Ids of the nodes on the critical path in the order they ran.
+			 */
+			std::vector< std::size_t > critical_nodes ;
+			/*
+			 * Time between the start of the first node and the end of the last one.
+			 */
+			std::chrono::nanoseconds elapsed{ 0 } ;
+			/*
+			 * Set if the graph has a cycle,no node runs in that case.
+			 */
+			bool cycle = false ;
+		};
+
+		template< typename Function >
+		node add( Function function )
+		{
+			m_nodes.emplace_back( std::move( function ) ) ;
+
+			return node{ m_nodes.size() - 1 } ;
+		}
+		/*
+		 * Adds a node that starts after all "after" nodes finished.
+		 */
+		template< typename Function >
+		node add( Function function,std::initializer_list< node > after )
+		{
+			auto e = this->add( std::move( function ) ) ;
+
+			for( const auto& it : after ){
+
+				this->add_edge( it,e ) ;
+			}
+
+			return e ;
+		}
+		/*
+		 * "to" starts after "from" finished. An edge to or from a node that is not in
+		 * the graph is ignored.
+		 */
+		void add_edge( node from,node to )
+		{
+			Q_ASSERT( from.id < m_nodes.size() && to.id < m_nodes.size() ) ;
+
+			if( from.id < m_nodes.size() && to.id < m_nodes.size() ){
+
+				m_nodes[ from.id ].successors.emplace_back( to.id ) ;
+				m_nodes[ to.id ].predecessors++ ;
+			}
+		}
+		std::size_t size() const
+		{
+			return m_nodes.size() ;
+		}
+		/*
+		 * Nodes run on Task::thread_pool() or on the given executor.
+		 */
+		Task::future< report >& run() ;
+		Task::future< report >& run( Task::executor& ) ;
+
+		friend class Task::detail::graph_runner ;
+	private:
+		struct vertex
+		{
+			vertex( Task::detail::move_only_function< void() > f ) :
+				function( std::move( f ) )
+			{
+			}
+			Task::detail::move_only_function< void() > function ;
+			std::vector< std::size_t > successors ;
+			std::size_t predecessors = 0 ;
+		};
+		std::vector< vertex > m_nodes ;
+	};
+
+	namespace detail
+	{
+		/*
+		 * Powers futures returned by Task::graph::run(). Nodes are started as QRunnable objects
+		 * and the bookkeeping done when a node finishes is guarded by a mutex,it is short
+		 * compared to the nodes.
+		 */
+		class graph_runner : public QObject,
+				     public Task::detail::task< Task::graph::report >,
+				     public Task::detail::recyclable
+		{
+		public:
+			graph_runner( std::vector< Task::graph::vertex > nodes,Task::executor * e ) :
+				m_nodes( std::move( nodes ) ),
+				m_executor( e ),
+				m_future( nullptr,this ),
+				m_state( m_nodes.size() )
+			{
+				for( std::size_t i = 0 ; i < m_nodes.size() ; i++ ){
+
+					m_state[ i ].pending = m_nodes[ i ].predecessors ;
+				}
+			}
+			Task::future< Task::graph::report >& Future()
+			{
+				return m_future ;
+			}
+		private:
+			using clock = std::chrono::steady_clock ;
+
+			struct state
+			{
+				std::size_t pending = 0 ;
+				std::chrono::nanoseconds before{ 0 } ;
+				std::chrono::nanoseconds path{ 0 } ;
+				std::size_t critical = npos ;
+			};
+
+			static const std::size_t npos = static_cast< std::size_t >( -1 ) ;
+
+			class node_task : public QRunnable
+			{
+			public:
+				node_task( graph_runner& r,std::size_t i ) : m_runner( r ),m_index( i )
+				{
+				}
+				void run() override
+				{
+					m_runner.run_node( m_index ) ;
+				}
+			private:
+				graph_runner& m_runner ;
+				std::size_t m_index ;
+			};
+
+			void task_start() override
+			{
+				m_start = clock::now() ;
+
+				if( this->cycle() || m_nodes.empty() ){
+
+					m_result.cycle = !m_nodes.empty() ;
+
+					m_delivery.deliver( m_future,this,m_result ) ;
+
+					this->deleteLater() ;
+				}else{
+					for( auto it : this->roots() ){
+
+						this->start( it ) ;
+					}
+				}
+			}
+			void task_cancel() override
+			{
+				this->deleteLater() ;
+			}
+			Task::graph::report task_get() override
+			{
+				this->deleteLater() ;
+
+				m_start = clock::now() ;
+
+				if( this->cycle() || m_nodes.empty() ){
+
+					m_result.cycle = !m_nodes.empty() ;
+
+					return m_result ;
+				}
+
+				auto ready = this->roots() ;
+
+				while( !ready.empty() ){
+
+					auto i = ready.back() ;
+
+					ready.pop_back() ;
+
+					auto s = clock::now() ;
+
+					m_nodes[ i ].function() ;
+
+					for( auto it : this->finished( i,clock::now() - s ) ){
+
+						ready.emplace_back( it ) ;
+					}
+				}
+
+				this->report() ;
+
+				return m_result ;
+			}
+			void start( std::size_t i )
+			{
+				auto e = new node_task( *this,i ) ;
+
+				if( m_executor ){
+
+					m_executor->start( e ) ;
+				}else{
+					Task::thread_pool().start( e ) ;
+				}
+			}
+			void run_node( std::size_t i )
+			{
+				auto s = clock::now() ;
+
+				m_nodes[ i ].function() ;
+
+				auto d = clock::now() - s ;
+
+				std::vector< std::size_t > ready ;
+
+				bool last ;
+
+				m_mutex.lock() ;
+
+				ready = this->finished( i,d ) ;
+
+				last = ++m_done == m_nodes.size() ;
+
+				m_mutex.unlock() ;
+
+				for( auto it : ready ){
+
+					this->start( it ) ;
+				}
+
+				if( last ){
+
+					this->report() ;
+
+					m_delivery.deliver( m_future,this,m_result ) ;
+
+					this->deleteLater() ;
+				}
+			}
+			/*
+			 * Returns successors of node "i" that became ready.
+			 */
+			std::vector< std::size_t > finished( std::size_t i,clock::duration d )
+			{
+				std::vector< std::size_t > ready ;
+
+				auto& e = m_state[ i ] ;
+
+				e.path = e.before + std::chrono::duration_cast< std::chrono::nanoseconds >( d ) ;
+
+				for( auto it : m_nodes[ i ].successors ){
+
+					auto& s = m_state[ it ] ;
+
+					if( s.critical == npos || e.path > s.before ){
+
+						s.before = e.path ;
+						s.critical = i ;
+					}
+
+					if( --s.pending == 0 ){
+
+						ready.emplace_back( it ) ;
+					}
+				}
+
+				return ready ;
+			}
+			std::vector< std::size_t > roots() const
+			{
+				std::vector< std::size_t > m ;
+
+				for( std::size_t i = 0 ; i < m_nodes.size() ; i++ ){
+
+					if( m_nodes[ i ].predecessors == 0 ){
+
+						m.emplace_back( i ) ;
+					}
+				}
+
+				return m ;
+			}
+			bool cycle() const
+			{
+				std::vector< std::size_t > pending( m_nodes.size() ) ;
+
+				for( std::size_t i = 0 ; i < m_nodes.size() ; i++ ){
+
+					pending[ i ] = m_nodes[ i ].predecessors ;
+				}
+
+				auto ready = this->roots() ;
+
+				std::size_t visited = 0 ;
+
+				while( !ready.empty() ){
+
+					auto i = ready.back() ;
+
+					ready.pop_back() ;
+
+					visited++ ;
+
+					for( auto it : m_nodes[ i ].successors ){
+
+						if( --pending[ it ] == 0 ){
+
+							ready.emplace_back( it ) ;
+						}
+					}
+				}
+
+				return visited != m_nodes.size() ;
+			}
+			void report()
+			{
+				m_result.elapsed = std::chrono::duration_cast< std::chrono::nanoseconds >( clock::now() - m_start ) ;
+
+				std::size_t end = 0 ;
+
+				for( std::size_t i = 1 ; i < m_state.size() ; i++ ){
+
+					if( m_state[ i ].path > m_state[ end ].path ){
+
+						end = i ;
+					}
+				}
+
+				m_result.critical_path = m_state[ end ].path ;
+
+				for( auto i = end ; i != npos ; i = m_state[ i ].critical ){
+
+					m_result.critical_nodes.emplace_back( i ) ;
+				}
+
+				std::reverse( m_result.critical_nodes.begin(),m_result.critical_nodes.end() ) ;
+			}
+			std::vector< Task::graph::vertex > m_nodes ;
+			Task::executor * m_executor ;
+			Task::future< Task::graph::report > m_future ;
+			Task::graph::report m_result ;
+			std::vector< state > m_state ;
+			std::size_t m_done = 0 ;
+			clock::time_point m_start ;
+			QMutex m_mutex ;
+			Task::detail::delivery m_delivery ;
+		};
+	}
+
+	inline Task::future< Task::graph::report >& graph::run()
+	{
+		auto e = new Task::detail::graph_runner( std::move( m_nodes ),nullptr ) ;
+
+		m_nodes.clear() ;
+
+		return e->Future() ;
+	}
+
+	inline Task::future< Task::graph::report >& graph::run( Task::executor& s )
+	{
+		auto e = new Task::detail::graph_runner( std::move( m_nodes ),&s ) ;
+
+		m_nodes.clear() ;
+
+		return e->Future() ;
+	}
+
+	/*
+	 * A bounded queue that many threads can push to and pop from without taking a lock,
+	 * the ring buffer of Dmitry Vyukov's MPMC queue. "capacity" is rounded up to a power of two.
+	 *
+	 * .push() and .pop() spin for a while when the queue is full or empty and then sleep
+	 * until the other side makes progress or the queue is closed.
+	 */
+	template< typename T >
+	class bounded_queue
+	{
+	public:
+		bounded_queue( std::size_t capacity ) :
+			m_size( bounded_queue::round( capacity ) ),
+			m_mask( m_size - 1 ),
+			m_cells( new cell[ m_size ] )
+		{
+			for( std::size_t i = 0 ; i < m_size ; i++ ){
+
+				m_cells[ i ].sequence.store( i,std::memory_order_relaxed ) ;
+			}
+		}
+		bounded_queue( const bounded_queue& ) = delete ;
+		bounded_queue& operator=( const bounded_queue& ) = delete ;
+		/*
+		 * Items that are still in the queue are destroyed where they are.
+		 */
+		~bounded_queue()
+		{
+			auto tail = m_tail.load( std::memory_order_relaxed ) ;
+
+			for( auto pos = m_head.load( std::memory_order_relaxed ) ; pos != tail ; pos++ ){
+
+				reinterpret_cast< T * >( &m_cells[ pos & m_mask ].storage )->~T() ;
+			}
+		}
+		std::size_t capacity() const
+		{
+			return m_size ;
+		}
+		bool try_push( T& e )
+		{
+			if( this->enqueue( e ) ){
+
+				this->wake( m_pop_sleepers,m_not_empty ) ;
+
+				return true ;
+			}else{
+				return false ;
+			}
+		}
+		bool try_pop( T& e )
+		{
+			if( this->dequeue( e ) ){
+
+				this->wake( m_push_sleepers,m_not_full ) ;
+
+				return true ;
+			}else{
+				return false ;
+			}
+		}
+		/*
+		 * Waits while the queue is full and returns false,dropping "e",if the queue was closed.
+		 */
+		bool push( T e )
+		{
+			if( this->wait( m_push_sleepers,m_not_full,[ & ](){ return this->enqueue( e ) ; } ) ){
+
+				this->wake( m_pop_sleepers,m_not_empty ) ;
+
+				return true ;
+			}else{
+				return false ;
+			}
+		}
+		/*
+		 * Waits while the queue is empty and returns false once it is closed and empty.
+		 */
+		bool pop( T& e )
+		{
+			if( this->wait( m_pop_sleepers,m_not_empty,[ & ](){ return this->dequeue( e ) ; } ) ){
+
+				this->wake( m_push_sleepers,m_not_full ) ;
+
+				return true ;
+			}else{
+				return false ;
+			}
+		}
+		/*
+		 * Same as .pop() but the item is passed to "function" and T does not have to be
+		 * default constructible or assignable.
+		 */
+		template< typename Function >
+		bool consume( Function function )
+		{
+			typename std::aligned_storage< sizeof( T ),alignof( T ) >::type storage ;
+
+			auto e = reinterpret_cast< T * >( &storage ) ;
+
+			auto take = [ & ](){
+
+				return this->dequeue( [ & ]( T& x ){ new ( e ) T( std::move( x ) ) ; } ) ;
+			} ;
+
+			if( this->wait( m_pop_sleepers,m_not_empty,take ) ){
+
+				this->wake( m_push_sleepers,m_not_full ) ;
+
+				struct destroy
+				{
+					~destroy()
+					{
+						item->~T() ;
+					}
+					T * item ;
+				} d{ e } ;
+
+				function( std::move( *e ) ) ;
+
+				return true ;
+			}else{
+				return false ;
+			}
+		}
+		/*
+		 * Wakes up all waiting threads. Items already in the queue can still be popped.
+		 */
+		void close()
+		{
+			QMutexLocker m( &m_mutex ) ;
+
+			m_closed.store( true,std::memory_order_release ) ;
+
+			m_not_full.wakeAll() ;
+			m_not_empty.wakeAll() ;
+		}
+		bool closed() const
+		{
+			return m_closed.load( std::memory_order_acquire ) ;
+		}
+	private:
+		struct cell
+		{
+			std::atomic< std::size_t > sequence ;
+			typename std::aligned_storage< sizeof( T ),alignof( T ) >::type storage ;
+		};
+		static std::size_t round( std::size_t s )
+		{
+			std::size_t e = 2 ;
+
+			while( e < s ){
+
+				e *= 2 ;
+			}
+
+			return e ;
+		}
+		bool enqueue( T& e )
+		{
+			auto pos = m_tail.load( std::memory_order_relaxed ) ;
+
+			while( true ){
+
+				auto& c = m_cells[ pos & m_mask ] ;
+
+				auto seq = c.sequence.load( std::memory_order_acquire ) ;
+
+				auto diff = static_cast< std::intptr_t >( seq ) - static_cast< std::intptr_t >( pos ) ;
+
+				if( diff == 0 ){
+
+					if( m_tail.compare_exchange_weak( pos,pos + 1,std::memory_order_relaxed ) ){
+
+						new ( &c.storage ) T( std::move( e ) ) ;
+
+						c.sequence.store( pos + 1,std::memory_order_release ) ;
+
+						return true ;
+					}
+				}else if( diff < 0 ){
+
+					return false ;
+				}else{
+					pos = m_tail.load( std::memory_order_relaxed ) ;
+				}
+			}
+		}
+		bool dequeue( T& e )
+		{
+			return this->dequeue( [ & ]( T& x ){ e = std::move( x ) ; } ) ;
+		}
+		/*
+		 * "function" is called with the item before its cell is given back to producers.
+		 */
+		template< typename Function >
+		bool dequeue( Function function )
+		{
+			auto pos = m_head.load( std::memory_order_relaxed ) ;
+
+			while( true ){
+
+				auto& c = m_cells[ pos & m_mask ] ;
+
+				auto seq = c.sequence.load( std::memory_order_acquire ) ;
+
+				auto diff = static_cast< std::intptr_t >( seq ) - static_cast< std::intptr_t >( pos + 1 ) ;
+
+				if( diff == 0 ){
+
+					if( m_head.compare_exchange_weak( pos,pos + 1,std::memory_order_relaxed ) ){
+
+						auto s = reinterpret_cast< T * >( &c.storage ) ;
+
+						function( *s ) ;
+
+						s->~T() ;
+
+						c.sequence.store( pos + m_size,std::memory_order_release ) ;
+
+						return true ;
+					}
+				}else if( diff < 0 ){
+
+					return false ;
+				}else{
+					pos = m_head.load( std::memory_order_relaxed ) ;
+				}
+			}
+		}
+		void wake( std::atomic< int >& sleepers,QWaitCondition& w )
+		{
+			std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+
+			if( sleepers.load( std::memory_order_relaxed ) > 0 ){
+
+				QMutexLocker m( &m_mutex ) ;
+
+				w.wakeAll() ;
+			}
+		}
+		template< typename Function >
+		bool wait( std::atomic< int >& sleepers,QWaitCondition& w,Function function )
+		{
+			for( int i = 0 ; i < 64 ; i++ ){
+
+				if( function() ){
+
+					return true ;
+
+				}else if( this->closed() ){
+
+					return function() ;
+				}
+
+				QThread::yieldCurrentThread() ;
+			}
+
+			QMutexLocker m( &m_mutex ) ;
+
+			sleepers.fetch_add( 1 ) ;
+
+			std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+
+			while( true ){
+
+				if( function() ){
+
+					break ;
+
+				}else if( this->closed() ){
+
+					sleepers.fetch_sub( 1 ) ;
+
+					return function() ;
+				}
+
+				w.wait( &m_mutex ) ;
+			}
+
+			sleepers.fetch_sub( 1 ) ;
+
+			return true ;
+		}
+		const std::size_t m_size ;
+		const std::size_t m_mask ;
+		std::unique_ptr< cell[] > m_cells ;
+		char m_padding0[ 64 ] ;
+		std::atomic< std::size_t > m_tail{ 0 } ;
+		char m_padding1[ 64 ] ;
+		std::atomic< std::size_t > m_head{ 0 } ;
+		char m_padding2[ 64 ] ;
+		std::atomic< bool > m_closed{ false } ;
+		std::atomic< int > m_push_sleepers{ 0 } ;
+		std::atomic< int > m_pop_sleepers{ 0 } ;
+		QMutex m_mutex ;
+		QWaitCondition m_not_full ;
+		QWaitCondition m_not_empty ;
+	};
+
+	namespace detail
+	{
+		/*
+		 * A stage of a Task::pipeline,.work() is called once by each of its workers.
+		 */
+		class pipeline_stage
+		{
+		public:
+			pipeline_stage( std::size_t workers ) : m_workers( workers < 1 ? 1 : workers )
+			{
+			}
+			virtual void work() = 0 ;
+			virtual ~pipeline_stage() = default ;
+			std::size_t workers() const
+			{
+				return m_workers ;
+			}
+		protected:
+			/*
+			 * Returns true for the last worker to finish.
+			 */
+			bool finished()
+			{
+				return ++m_finished == m_workers ;
+			}
+		private:
+			std::size_t m_workers ;
+			std::atomic< std::size_t > m_finished{ 0 } ;
+		};
+
+		template< typename T,typename Function >
+		class pipeline_source : public Task::detail::pipeline_stage
+		{
+		public:
+			pipeline_source( Function function,std::size_t capacity ) :
+				Task::detail::pipeline_stage( 1 ),
+				m_function( std::move( function ) ),
+				m_output( capacity )
+			{
+			}
+			Task::bounded_queue< T >& output()
+			{
+				return m_output ;
+			}
+			void work() override
+			{
+				m_function( m_output ) ;
+
+				m_output.close() ;
+			}
+		private:
+			Function m_function ;
+			Task::bounded_queue< T > m_output ;
+		};
+
+		template< typename T,typename U,typename Function >
+		class pipeline_transform : public Task::detail::pipeline_stage
+		{
+		public:
+			pipeline_transform( Task::bounded_queue< T >& input,
+					    Function function,
+					    std::size_t workers,
+					    std::size_t capacity ) :
+				Task::detail::pipeline_stage( workers ),
+				m_input( input ),
+				m_function( std::move( function ) ),
+				m_output( capacity )
+			{
+			}
+			Task::bounded_queue< U >& output()
+			{
+				return m_output ;
+			}
+			void work() override
+			{
+				while( m_input.consume( [ this ]( T&& e ){ m_output.push( m_function( std::move( e ) ) ) ; } ) ){}
+
+				if( this->finished() ){
+
+					m_output.close() ;
+				}
+			}
+		private:
+			Task::bounded_queue< T >& m_input ;
+			Function m_function ;
+			Task::bounded_queue< U > m_output ;
+		};
+
+		template< typename T,typename Function >
+		class pipeline_transform< T,void,Function > : public Task::detail::pipeline_stage
+		{
+		public:
+			pipeline_transform( Task::bounded_queue< T >& input,
+					    Function function,
+					    std::size_t workers,
+					    std::size_t ) :
+				Task::detail::pipeline_stage( workers ),
+				m_input( input ),
+				m_function( std::move( function ) )
+			{
+			}
+			void work() override
+			{
+				while( m_input.consume( [ this ]( T&& e ){ m_function( std::move( e ) ) ; } ) ){}
+
+				this->finished() ;
+			}
+		private:
+			Task::bounded_queue< T >& m_input ;
+			Function m_function ;
+		};
+
+		class pipeline_runner ;
+
+		inline Task::executor& pipeline_executor()
+		{
+			static Task::thread_executor e ;
+
+			return e ;
+		}
+	}
+
+	/*
+	 * Items made by a source function flow through stages that run at the same time,each
+	 * stage with as many workers as it was given and connected to the next one by a
+	 * Task::bounded_queue of "capacity" items. A stage that is faster than the one after it
+	 * waits when the queue between them is full and memory therefore stays bounded.
+	 *
+	 * The source is called once with the queue to push items to and the pipeline ends after
+	 * the source returned and all items were consumed by the last stage,a stage that returns
+	 * void. Items may get out of order in a stage with more than one worker.
+	 *
+	 * Task::pipeline< QByteArray >( []( Task::bounded_queue< QByteArray >& out ){
+	 *
+	 *	while( ... ){
+	 *
+	 *		out.push( read() ) ;
+	 *	}
+	 * } ).stage( 4,parse ).stage( 1,store ).run().await() ;
+	 */
+	template< typename T >
+	class pipeline
+	{
+	public:
+		template< typename Source >
+		pipeline( Source source,std::size_t capacity = 1024 ) : m_capacity( capacity )
+		{
+			auto e = new Task::detail::pipeline_source< T,Source >( std::move( source ),capacity ) ;
+
+			m_output = &e->output() ;
+
+			m_stages.emplace_back( e ) ;
+		}
+		/*
+		 * Adds a stage that calls "function" on items of the previous stage on "workers" threads.
+		 * The stages move to the returned pipeline and this one is left empty.
+		 */
+		template< typename Function,typename U = Task::detail::result_of< Function,T > >
+		Task::pipeline< U > stage( std::size_t workers,Function function ) &&
+		{
+			using stage_type = Task::detail::pipeline_transform< T,U,Function > ;
+
+			auto e = new stage_type( *m_output,std::move( function ),workers,m_capacity ) ;
+
+			m_stages.emplace_back( e ) ;
+
+			return Task::pipeline< U >( std::move( m_stages ),m_capacity,pipeline::output( e ) ) ;
+		}
+		template< typename U >
+		friend class Task::pipeline ;
+	private:
+		pipeline( std::vector< std::unique_ptr< Task::detail::pipeline_stage > > stages,
+			  std::size_t capacity,
+			  Task::bounded_queue< T > * output ) :
+			m_stages( std::move( stages ) ),
+			m_capacity( capacity ),
+			m_output( output )
+		{
+		}
+		template< typename Stage >
+		static auto output( Stage * e ) -> decltype( &e->output() )
+		{
+			return &e->output() ;
+		}
+		static std::nullptr_t output( ... )
+		{
+			return nullptr ;
+		}
+		std::vector< std::unique_ptr< Task::detail::pipeline_stage > > m_stages ;
+		std::size_t m_capacity ;
+		Task::bounded_queue< T > * m_output = nullptr ;
+	};
+
+	/*
+	 * The type a pipeline has after its last stage,it has no output queue.
+	 */
+	template<>
+	class pipeline< void >
+	{
+	public:
+		/*
+		 * Workers of stages run on threads of their own or on the given executor,which must
+		 * be able to run all of them at the same time since they block on their queues.
+		 */
+		Task::future< void >& run()
+		{
+			return this->run( Task::detail::pipeline_executor() ) ;
+		}
+		Task::future< void >& run( Task::executor& ) ;
+
+		template< typename U >
+		friend class Task::pipeline ;
+	private:
+		pipeline( std::vector< std::unique_ptr< Task::detail::pipeline_stage > > stages,
+			  std::size_t,
+			  std::nullptr_t ) :
+			m_stages( std::move( stages ) )
+		{
+		}
+		std::vector< std::unique_ptr< Task::detail::pipeline_stage > > m_stages ;
+	};
+
+	namespace detail
+	{
+		/*
+		 * Powers futures returned by Task::pipeline::run(). Every worker of every stage is
+		 * started as a QRunnable and the last one to finish resolves the future.
+		 */
+		class pipeline_runner : public QObject,
+					public Task::detail::task< void >,
+					public Task::detail::recyclable
+		{
+		public:
+			pipeline_runner( std::vector< std::unique_ptr< Task::detail::pipeline_stage > > stages,
+					 Task::executor& e ) :
+				m_stages( std::move( stages ) ),
+				m_executor( e ),
+				m_future( nullptr,this )
+			{
+				for( const auto& it : m_stages ){
+
+					m_workers += it->workers() ;
+				}
+			}
+			Task::future< void >& Future()
+			{
+				return m_future ;
+			}
+		private:
+			class worker : public QRunnable
+			{
+			public:
+				worker( pipeline_runner& r,Task::detail::pipeline_stage& s ) :
+					m_runner( r ),m_stage( s )
+				{
+				}
+				void run() override
+				{
+					m_stage.work() ;
+
+					m_runner.finished() ;
+				}
+			private:
+				pipeline_runner& m_runner ;
+				Task::detail::pipeline_stage& m_stage ;
+			};
+
+			void task_start() override
+			{
+				this->start() ;
+			}
+			void task_cancel() override
+			{
+				this->deleteLater() ;
+			}
+			void task_get() override
+			{
+				this->deleteLater() ;
+
+				m_wait = true ;
+
+				this->start() ;
+
+				m_done.acquire( static_cast< int >( m_workers ) ) ;
+			}
+			void start()
+			{
+				for( const auto& it : m_stages ){
+
+					for( std::size_t i = 0 ; i < it->workers() ; i++ ){
+
+						m_executor.start( new worker( *this,*it ) ) ;
+					}
+				}
+			}
+			void finished()
+			{
+				/*
+				 * The runner may be gone right after the increment unless this is the last worker.
+				 */
+				auto workers = m_workers ;
+
+				if( m_wait ){
+
+					m_done.release() ;
+
+				}else if( ++m_finished == workers ){
+
+					m_delivery.deliver( m_future,this ) ;
+
+					this->deleteLater() ;
+				}
+			}
+			std::vector< std::unique_ptr< Task::detail::pipeline_stage > > m_stages ;
+			Task::executor& m_executor ;
+			Task::future< void > m_future ;
+			std::size_t m_workers = 0 ;
+			std::atomic< std::size_t > m_finished{ 0 } ;
+			bool m_wait = false ;
+			QSemaphore m_done ;
+			Task::detail::delivery m_delivery ;
+		};
+	}
+
+	inline Task::future< void >& pipeline< void >::run( Task::executor& e )
+	{
+		auto s = new Task::detail::pipeline_runner( std::move( m_stages ),e ) ;
+
+		m_stages.clear() ;
+
+		return s->Future() ;
+	}
+
+#if __cplusplus > 201703L
+	/*
+	 * C++20 coroutine support.
+	 *
+	 * "co_await Task::run( foo )" suspends the current coroutine until the task finishes and
+	 * the coroutine is resumed on the thread that created the future,the same thread a
+	 * continuation passed to .then() runs on.
+	 *
+	 * A function that returns Task::coroutine<T> is a coroutine whose body runs on the thread
+	 * that starts it and resumes on the same thread after each co_await. It does not start until
+	 * .then(),.await(),.start() or co_await is called on it,just like a future returned by Task::run().
+	 */
+	template< typename T >
+	class coroutine ;
+
+	namespace detail
+	{
+		class future_awaiter_base
+		{
+		public:
+			bool await_ready() const noexcept
+			{
+				return false ;
+			}
+		protected:
+			/*
+			 * The continuation runs on the thread that owns the future,which is the thread the
+			 * coroutine is running on. It runs before .await_suspend() returns if the task was run
+			 * by Task::inline_executor and the coroutine then continues without suspending.
+			 */
+			template< typename Future,typename Function >
+			bool suspend( Future& e,std::coroutine_handle<> h,Function function )
+			{
+				m_handle = h ;
+
+				e.then( std::move( function ) ) ;
+
+				m_suspended = !m_finished ;
+
+				return m_suspended ;
+			}
+			void resume()
+			{
+				m_finished = true ;
+
+				/*
+				 * This object lives in the frame of the coroutine,which can finish and
+				 * go away before resume() returns.
+				 */
+				auto h = std::exchange( m_handle,nullptr ) ;
+
+				if( m_suspended ){
+
+					h.resume() ;
+				}
+			}
+		private:
+			std::coroutine_handle<> m_handle ;
+			bool m_suspended = false ;
+			bool m_finished = false ;
+		};
+
+		template< typename T >
+		class future_awaiter : public future_awaiter_base
+		{
+		public:
+			future_awaiter( Task::future< T >& e ) : m_future( e )
+			{
+			}
+			bool await_suspend( std::coroutine_handle<> h )
+			{
+				return this->suspend( m_future,h,[ this ]( T&& e ){
+
+					m_result = std::move( e ) ;
+
+					this->resume() ;
+				} ) ;
+			}
+			T await_resume()
+			{
+				return std::move( m_result ) ;
+			}
+		private:
+			Task::future< T >& m_future ;
+			T m_result ;
+		};
+
+		template<>
+		class future_awaiter< void > : public future_awaiter_base
+		{
+		public:
+			future_awaiter( Task::future< void >& e ) : m_future( e )
+			{
+			}
+			bool await_suspend( std::coroutine_handle<> h )
+			{
+				return this->suspend( m_future,h,[ this ](){ this->resume() ; } ) ;
+			}
+			void await_resume()
+			{
+			}
+		private:
+			Task::future< void >& m_future ;
+		};
+
+		template< typename T >
+		class coroutine_promise ;
+
+		template< typename T >
+		class coroutine_awaiter ;
+
+		/*
+		 * The coroutine frame holds the future and is deleted when the coroutine finishes,
+		 * right after the continuation of the future has run.
+		 *
+		 * A coroutine that is awaited by another coroutine is started and,when it finishes,
+		 * resumes the one that awaits it by returning its handle from .await_suspend(),a
+		 * chain of awaits of any depth runs without growing the stack.
+		 *
+		 * An exception that escapes a coroutine is rethrown by co_await and by .await() and .get()
+		 * of Task::coroutine. A continuation given to .then() is called with a default constructed
+		 * result instead.
+		 */
+		template< typename T >
+		class coroutine_promise_base : public Task::detail::task< T >,
+					       public Task::detail::recyclable
+		{
+		public:
+			coroutine_promise_base() : m_future( nullptr,this )
+			{
+			}
+			std::suspend_always initial_suspend() noexcept
+			{
+				return {} ;
+			}
+			struct final_awaiter
+			{
+				bool await_ready() noexcept
+				{
+					return false ;
+				}
+				template< typename Promise >
+				std::coroutine_handle<> await_suspend( std::coroutine_handle< Promise > h ) noexcept
+				{
+					auto& p = h.promise() ;
+
+					auto e = std::exchange( p.m_continuation,nullptr ) ;
+
+					p.m_handle = nullptr ;
+
+					if( e ){
+
+						p.finish( *p.m_awaiter ) ;
+
+						h.destroy() ;
+
+						return e ;
+					}else{
+						if( p.m_exception_slot ){
+
+							*p.m_exception_slot = p.m_exception ;
+						}
+
+						p.finish() ;
+
+						h.destroy() ;
+
+						return std::noop_coroutine() ;
+					}
+				}
+				void await_resume() noexcept
+				{
+				}
+			};
+			final_awaiter final_suspend() noexcept
+			{
+				return {} ;
+			}
+			void unhandled_exception()
+			{
+				m_exception = std::current_exception() ;
+			}
+			/*
+			 * Called by a coroutine that awaits this one,returns the handle to resume.
+			 */
+			std::coroutine_handle<> start( std::coroutine_handle<> continuation,Task::detail::coroutine_awaiter< T > * awaiter )
+			{
+				m_started = true ;
+				m_continuation = continuation ;
+				m_awaiter = awaiter ;
+
+				return m_handle ;
+			}
+			/*
+			 * Called by Task::coroutine::await() and .get() before the coroutine starts.
+			 */
+			void exception_slot( std::exception_ptr * e )
+			{
+				m_exception_slot = e ;
+			}
+		protected:
+			void task_start() override
+			{
+				if( !m_started ){
+
+					m_started = true ;
+					m_handle.resume() ;
+				}
+			}
+			void task_cancel() override
+			{
+				/*
+				 * A coroutine can only be cancelled before it starts. The frame holds
+				 * this object and the handle is cleared before the frame goes away.
+				 */
+				if( !m_started ){
+
+					std::exchange( m_handle,nullptr ).destroy() ;
+				}
+			}
+			T task_get() override
+			{
+				return m_future.await() ;
+			}
+			std::coroutine_handle<> m_handle ;
+			std::coroutine_handle<> m_continuation ;
+			Task::detail::coroutine_awaiter< T > * m_awaiter = nullptr ;
+			std::exception_ptr m_exception ;
+			std::exception_ptr * m_exception_slot = nullptr ;
+			bool m_started = false ;
+			Task::future< T > m_future ;
+		};
+
+		template< typename T >
+		class coroutine_promise : public coroutine_promise_base< T >
+		{
+		public:
+			Task::coroutine< T > get_return_object() ;
+
+			template< typename E >
+			void return_value( E&& e )
+			{
+				m_result = std::forward< E >( e ) ;
+			}
+			void finish()
+			{
+				this->m_future.run( std::move( m_result ) ) ;
+			}
+			void finish( Task::detail::coroutine_awaiter< T >& e )
+			{
+				e.set( std::move( m_result ),std::move( this->m_exception ) ) ;
+			}
+		private:
+			T m_result{} ;
+		};
+
+		template<>
+		class coroutine_promise< void > : public coroutine_promise_base< void >
+		{
+		public:
+			Task::coroutine< void > get_return_object() ;
+
+			void return_void()
+			{
+			}
+			void finish()
+			{
+				this->m_future.run() ;
+			}
+			void finish( Task::detail::coroutine_awaiter< void >& e ) ;
+		};
+
+		/*
+		 * Awaits a Task::coroutine from another coroutine.
+		 */
+		template< typename T >
+		class coroutine_awaiter
+		{
+		public:
+			coroutine_awaiter( std::coroutine_handle< Task::detail::coroutine_promise< T > > h ) :
+				m_handle( h )
+			{
+			}
+			bool await_ready() const noexcept
+			{
+				return false ;
+			}
+			std::coroutine_handle<> await_suspend( std::coroutine_handle<> h )
+			{
+				return m_handle.promise().start( h,this ) ;
+			}
+			T await_resume()
+			{
+				if( m_exception ){
+
+					std::rethrow_exception( m_exception ) ;
+				}
+
+				return std::move( m_result ) ;
+			}
+			/*
+			 * Called by the awaited coroutine right before its frame is destroyed.
+			 */
+			void set( T e,std::exception_ptr m )
+			{
+				m_handle = nullptr ;
+				m_result = std::move( e ) ;
+				m_exception = std::move( m ) ;
+			}
+		private:
+			std::coroutine_handle< Task::detail::coroutine_promise< T > > m_handle ;
+			std::exception_ptr m_exception ;
+			T m_result ;
+		};
+
+		template<>
+		class coroutine_awaiter< void >
+		{
+		public:
+			coroutine_awaiter( std::coroutine_handle< Task::detail::coroutine_promise< void > > h ) :
+				m_handle( h )
+			{
+			}
+			bool await_ready() const noexcept
+			{
+				return false ;
+			}
+			std::coroutine_handle<> await_suspend( std::coroutine_handle<> h )
+			{
+				return m_handle.promise().start( h,this ) ;
+			}
+			void await_resume()
+			{
+				if( m_exception ){
+
+					std::rethrow_exception( m_exception ) ;
+				}
+			}
+			void set( std::exception_ptr m )
+			{
+				m_handle = nullptr ;
+				m_exception = std::move( m ) ;
+			}
+		private:
+			std::coroutine_handle< Task::detail::coroutine_promise< void > > m_handle ;
+			std::exception_ptr m_exception ;
+		};
+
+		inline void coroutine_promise< void >::finish( Task::detail::coroutine_awaiter< void >& e )
+		{
+			e.set( std::move( this->m_exception ) ) ;
+		}
+	}
+
+	template< typename T >
+	class coroutine
+	{
+	public:
+		using promise_type = Task::detail::coroutine_promise< T > ;
+
+		coroutine( std::coroutine_handle< promise_type > h,Task::future< T >& e ) :
+			m_handle( h ),m_future( e )
+		{
+		}
+		operator Task::future< T >&()
+		{
+			return m_future ;
+		}
+		Task::future< T >& future()
+		{
+			return m_future ;
+		}
+		std::coroutine_handle< promise_type > handle()
+		{
+			return m_handle ;
+		}
+		/*
+		 * The continuation is called with a default constructed result if an exception
+		 * escapes the coroutine,use .await() or .get() to have it rethrown.
+		 *
+		 * The coroutine frame goes away when the coroutine finishes and the handle is
+		 * cleared by this and the functions below,each of them can be called once.
+		 */
+		template< typename Function >
+		void then( Function function )
+		{
+			m_handle = nullptr ;
+			m_future.then( std::move( function ) ) ;
+		}
+		T await()
+		{
+			std::exception_ptr e ;
+
+			std::exchange( m_handle,nullptr ).promise().exception_slot( &e ) ;
+
+			return this->rethrow( e,m_future.await() ) ;
+		}
+		T get()
+		{
+			std::exception_ptr e ;
+
+			std::exchange( m_handle,nullptr ).promise().exception_slot( &e ) ;
+
+			return this->rethrow( e,m_future.get() ) ;
+		}
+		void start()
+		{
+			m_handle = nullptr ;
+			m_future.start() ;
+		}
+		void cancel()
+		{
+			m_handle = nullptr ;
+			m_future.cancel() ;
+		}
+	private:
+		template< typename E >
+		static E rethrow( std::exception_ptr& e,E&& r )
+		{
+			if( e ){
+
+				std::rethrow_exception( e ) ;
+			}
+
+			return std::forward< E >( r ) ;
+		}
+		std::coroutine_handle< promise_type > m_handle ;
+		Task::future< T >& m_future ;
+	};
+
+	template<>
+	inline void coroutine< void >::get()
+	{
+		std::exception_ptr e ;
+
+		std::exchange( m_handle,nullptr ).promise().exception_slot( &e ) ;
+
+		m_future.get() ;
+
+		if( e ){
+
+			std::rethrow_exception( e ) ;
+		}
+	}
+
+	template<>
+	inline void coroutine< void >::await()
+	{
+		std::exception_ptr e ;
+
+		std::exchange( m_handle,nullptr ).promise().exception_slot( &e ) ;
+
+		m_future.await() ;
+
+		if( e ){
+
+			std::rethrow_exception( e ) ;
+		}
+	}
+
+	template< typename T >
+	Task::coroutine< T > detail::coroutine_promise< T >::get_return_object()
+	{
+		this->m_handle = std::coroutine_handle< coroutine_promise >::from_promise( *this ) ;
+
+		return { std::coroutine_handle< coroutine_promise >::from_promise( *this ),this->m_future } ;
+	}
+
+	inline Task::coroutine< void > detail::coroutine_promise< void >::get_return_object()
+	{
+		this->m_handle = std::coroutine_handle< coroutine_promise >::from_promise( *this ) ;
+
+		return { std::coroutine_handle< coroutine_promise >::from_promise( *this ),this->m_future } ;
+	}
+
+	template< typename T >
+	Task::detail::future_awaiter< T > operator co_await( Task::future< T >& e )
+	{
+		return e ;
+	}
+
+	template< typename T >
+	Task::detail::coroutine_awaiter< T > operator co_await( Task::coroutine< T > e )
+	{
+		return e.handle() ;
+	}
+#endif
+
+	namespace process {
+
+		class result{
+		public:
+			result() = default ;
+			result( int exit_code ) :
+				m_finished( true ),
+				m_exitCode( exit_code ),
+				m_exitStatus( 0 )
+			{
+			}
+			template< typename E,typename F >
+			result( E&& std_out,
+				F&& std_error,
+				int exit_code,
+				int exit_status,
+				bool finished,
+				QString error = QString() ) :
+				m_stdOut( std::forward<E>( std_out ) ),
+				m_stdError( std::forward<F>( std_error ) ),
+				m_error( std::move( error ) ),
+				m_finished( finished ),
+				m_exitCode( exit_code ),
+				m_exitStatus( exit_status )
+			{
+			}
+			result( QProcess& e,int s )
+			{
+				m_finished   = e.waitForFinished( s ) ;
+				m_stdOut     = e.readAllStandardOutput() ;
+				m_stdError   = e.readAllStandardError() ;
+				m_exitCode   = e.exitCode() ;
+				m_exitStatus = e.exitStatus() ;
+			}
+			const QByteArray& std_out() const
+			{
+				return m_stdOut ;
+			}
+			const QByteArray& std_error() const
+			{
+				return m_stdError ;
+			}
+			bool finished() const
+			{
+				return m_finished ;
+			}
+			/*
+			 * Describes what went wrong with a channel of a Task::process::stream,like a file
+			 * that could not be written to. Empty if nothing did.
+			 */
+			const QString& error() const
+			{
+				return m_error ;
+			}
+			bool success() const
+			{
+				return m_exitCode == 0 &&
+				       m_exitStatus == QProcess::NormalExit &&
+				       m_finished == true &&
+				       m_error.isEmpty() ;
+			}
+			bool failed() const
+			{
+				return !this->success() ;
+			}
+			int exit_code() const
+			{
+				return m_exitCode ;
+			}
+			int exit_status() const
+			{
+				return m_exitStatus ;
+			}
+		private:
+			QByteArray m_stdOut ;
+			QByteArray m_stdError ;
+			QString m_error ;
+			bool m_finished = false ;
+			int m_exitCode = 255 ;
+			int m_exitStatus = 255 ;
+		};
+
+		/*
+		 * Output of a process that is handed over while it runs instead of being collected
+		 * in Task::process::result.
+		 *
+		 * A channel given a function has its output passed to it as soon as it is read,on the
+		 * thread that waits on the process or on the thread of "context" through a
+		 * Task::typed_progress. A channel given a path has its output written to that file,
+		 * its output is dropped and result::error() says why if the file can not be written.
+		 * Output of such channels is not kept in the result and other channels are kept up
+		 * to .cap() bytes each.
+		 */
+		class stream
+		{
+		public:
+			template< typename Function >
+			stream& std_out( Function function )
+			{
+				return this->set( m_stdOut,nullptr,std::move( function ) ) ;
+			}
+			template< typename Function >
+			stream& std_out( QObject * context,Function function )
+			{
+				return this->set( m_stdOut,context,std::move( function ) ) ;
+			}
+			stream& std_out_file( const QString& path )
+			{
+				return this->set( m_stdOut,path ) ;
+			}
+			template< typename Function >
+			stream& std_error( Function function )
+			{
+				return this->set( m_stdError,nullptr,std::move( function ) ) ;
+			}
+			template< typename Function >
+			stream& std_error( QObject * context,Function function )
+			{
+				return this->set( m_stdError,context,std::move( function ) ) ;
+			}
+			stream& std_error_file( const QString& path )
+			{
+				return this->set( m_stdError,path ) ;
+			}
+			/*
+			 * Pass output to functions one line at a time,without the new line character.
+			 */
+			stream& lines( bool e = true )
+			{
+				m_lines = e ;
+				return *this ;
+			}
+			/*
+			 * Keep at most the first "bytes" bytes of output in the result. With .lines(),
+			 * lines passed to functions are cut to "bytes" bytes and the rest of a longer
+			 * line is dropped.
+			 */
+			stream& cap( qint64 bytes )
+			{
+				m_cap = bytes ;
+				return *this ;
+			}
+			struct channel
+			{
+				std::function< void( const QByteArray& ) > function ;
+				Task::detail::object_guard context ;
+				QString path ;
+			};
+			const channel& std_out() const
+			{
+				return m_stdOut ;
+			}
+			const channel& std_error() const
+			{
+				return m_stdError ;
+			}
+			bool lines() const
+			{
+				return m_lines ;
+			}
+			qint64 cap() const
+			{
+				return m_cap ;
+			}
+		private:
+			template< typename Function >
+			stream& set( channel& c,QObject * context,Function function )
+			{
+				c.function = std::move( function ) ;
+				c.context  = context ? Task::detail::object_guard( context ) : Task::detail::object_guard() ;
+				c.path     = QString() ;
+				return *this ;
+			}
+			stream& set( channel& c,const QString& path )
+			{
+				c.function = nullptr ;
+				c.context  = Task::detail::object_guard() ;
+				c.path     = path ;
+				return *this ;
+			}
+			channel m_stdOut ;
+			channel m_stdError ;
+			bool m_lines = false ;
+			qint64 m_cap = -1 ;
+		};
+
+		namespace detail
+		{
+			class Process : public QProcess{
+			public:
+				Process( std::function< void() > function,
+					 const QProcessEnvironment& env ) :
+					 m_function( std::move( function  ) )
+				{
+					this->setProcessEnvironment( env ) ;
+				}
+			protected:
+				void setupChildProcess()
+				{
+					m_function() ;
+				}
+			private:
+				std::function< void() > m_function ;
+			} ;
+
+			static inline void start( Process& exe,const QString& cmd,const QStringList& args )
+			{
+				if( args.isEmpty() ){
+
+					#if QT_VERSION < QT_VERSION_CHECK( 5,15,0 )
+						exe.start( cmd ) ;
+					#else
+						exe.start( cmd,args ) ;
+					#endif
+				}else{
+					exe.start( cmd,args ) ;
+				}
+			}
+
+			static inline void start( Process& exe,
+						  const QString& cmd,
+						  const QStringList& args,
+						  int waitTime,
+						  const QByteArray& password )
+			{
+				Task::process::detail::start( exe,cmd,args ) ;
+
+				if( !password.isEmpty() ){
+
+					exe.waitForStarted( waitTime ) ;
+					exe.write( password ) ;
+					exe.closeWriteChannel() ;
+				}
+			}
+
+			static inline auto task( const QString& cmd,
+						 const QStringList& args,
+						 int waitTime,
+						 const QByteArray& password,
+						 const QProcessEnvironment& env,
+						 std::function< void() > setUp_child_process )
+			{
+				return [ = ](){
+
+					Process exe( std::move( setUp_child_process ),env ) ;
+
+					Task::process::detail::start( exe,cmd,args,waitTime,password ) ;
+
+					return result( exe,waitTime ) ;
+				} ;
+			}
+
+			/*
+			 * Takes output of one channel of a streamed process as it is read.
+			 */
+			class output
+			{
+			public:
+				output( const Task::process::stream::channel& c,const Task::process::stream& s ) :
+					m_function( c.function ),
+					m_lines( s.lines() ),
+					m_to_file( !c.path.isEmpty() ),
+					m_cap( s.cap() )
+				{
+					if( m_to_file ){
+
+						m_file.setFileName( c.path ) ;
+
+						if( !m_file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ){
+
+							m_error = c.path + ": " + m_file.errorString() ;
+						}
+
+					}else if( c.function && c.context ){
+
+						m_progress.reset( new Task::typed_progress< QByteArray >( c.context,[ f = c.function ]( QByteArray e ){
+
+							f( e ) ;
+						} ) ) ;
+					}
+				}
+				void add( const QByteArray& e )
+				{
+					if( e.isEmpty() ){
+
+						return ;
+
+					}else if( m_to_file ){
+
+						if( m_file.isOpen() && m_file.write( e ) != e.size() && m_error.isEmpty() ){
+
+							m_error = m_file.fileName() + ": " + m_file.errorString() ;
+						}
+
+					}else if( !m_function ){
+
+						this->keep( e ) ;
+
+					}else if( m_lines ){
+
+						int start = 0 ;
+
+						while( true ){
+
+							auto i = e.indexOf( '\n',start ) ;
+
+							if( i == -1 ){
+
+								this->keep( e.mid( start ) ) ;
+
+								break ;
+							}
+
+							this->keep( e.mid( start,i - start ) ) ;
+
+							this->deliver( m_data ) ;
+
+							m_data.clear() ;
+
+							start = i + 1 ;
+						}
+					}else{
+						this->deliver( e ) ;
+					}
+				}
+				/*
+				 * Returns what the result keeps of the channel.
+				 */
+				QByteArray finish()
+				{
+					if( m_function ){
+
+						if( !m_data.isEmpty() ){
+
+							this->deliver( m_data ) ;
+						}
+
+						return QByteArray() ;
+					}else{
+						return std::move( m_data ) ;
+					}
+				}
+				/*
+				 * Errors of both channels for result::error().
+				 */
+				static QString error( const output& a,const output& b )
+				{
+					if( a.m_error.isEmpty() ){
+
+						return b.m_error ;
+
+					}else if( b.m_error.isEmpty() ){
+
+						return a.m_error ;
+					}else{
+						return a.m_error + "\n" + b.m_error ;
+					}
+				}
+			private:
+				/*
+				 * Appends to the data of the channel,or to the line that is not finished yet,
+				 * up to .cap() bytes.
+				 */
+				void keep( const QByteArray& e )
+				{
+					if( m_cap < 0 ){
+
+						m_data += e ;
+
+					}else if( m_data.size() < m_cap ){
+
+						m_data += e.left( static_cast< int >( m_cap - m_data.size() ) ) ;
+					}
+				}
+				void deliver( const QByteArray& e )
+				{
+					if( m_progress ){
+
+						m_progress->update( e ) ;
+					}else{
+						m_function( e ) ;
+					}
+				}
+				std::function< void( const QByteArray& ) > m_function ;
+				bool m_lines ;
+				bool m_to_file ;
+				qint64 m_cap ;
+				QByteArray m_data ;
+				QFile m_file ;
+				QString m_error ;
+				std::unique_ptr< Task::typed_progress< QByteArray > > m_progress ;
+			};
+
+			static inline auto task( const QString& cmd,
+						 const QStringList& args,
+						 const Task::process::stream& stream,
+						 int waitTime,
+						 const QByteArray& password,
+						 const QProcessEnvironment& env,
+						 std::function< void() > setUp_child_process )
+			{
+				return [ = ](){
+
+					using clock = std::chrono::steady_clock ;
+
+					Process exe( std::move( setUp_child_process ),env ) ;
+
+					output std_out( stream.std_out(),stream ) ;
+					output std_error( stream.std_error(),stream ) ;
+
+					auto s = clock::now() ;
+
+					Task::process::detail::start( exe,cmd,args,waitTime,password ) ;
+
+					bool finished = exe.waitForStarted( waitTime ) ;
+
+					while( finished && exe.state() != QProcess::NotRunning ){
+
+						int slice = 100 ;
+
+						if( waitTime != -1 ){
+
+							auto e = std::chrono::duration_cast< std::chrono::milliseconds >( clock::now() - s ) ;
+
+							auto left = waitTime - static_cast< int >( e.count() ) ;
+
+							if( left <= 0 ){
+
+								finished = false ;
+
+								break ;
+
+							}else if( left < slice ){
+
+								slice = left ;
+							}
+						}
+
+						exe.waitForReadyRead( slice ) ;
+
+						std_out.add( exe.readAllStandardOutput() ) ;
+						std_error.add( exe.readAllStandardError() ) ;
+					}
+
+					std_out.add( exe.readAllStandardOutput() ) ;
+					std_error.add( exe.readAllStandardError() ) ;
+
+					return result( std_out.finish(),
+						       std_error.finish(),
+						       exe.exitCode(),
+						       exe.exitStatus(),
+						       finished,
+						       output::error( std_out,std_error ) ) ;
+				} ;
+			}
+
+			class watcher ;
+		}
+
+		/*
+		 * A thread with an event loop that waits on processes through QProcess signals,one
+		 * thread for any number of processes instead of a blocked thread per process.
+		 * See Task::process::io_thread().
+		 */
+		class multiplexer
+		{
+		public:
+			multiplexer()
+			{
+				m_object.moveToThread( &m_thread ) ;
+
+				m_thread.start() ;
+			}
+			multiplexer( const multiplexer& ) = delete ;
+			multiplexer& operator=( const multiplexer& ) = delete ;
+			~multiplexer()
+			{
+				m_thread.quit() ;
+
+				m_thread.wait() ;
+			}
+			/*
+			 * Returns true if called on the thread of the multiplexer.
+			 */
+			bool current() const
+			{
+				return QThread::currentThread() == &m_thread ;
+			}
+			friend class Task::process::detail::watcher ;
+		private:
+			template< typename Function >
+			void post( Function function )
+			{
+				QMetaObject::invokeMethod( &m_object,std::move( function ),Qt::QueuedConnection ) ;
+			}
+			QThread m_thread ;
+			QObject m_object ;
+		};
+
+		inline Task::process::multiplexer& io_thread()
+		{
+			static Task::process::multiplexer m ;
+
+			return m ;
+		}
+
+		namespace detail
+		{
+			struct arguments
+			{
+				QString cmd ;
+				QStringList args ;
+				Task::process::stream stream ;
+				int waitTime ;
+				QByteArray password ;
+				QProcessEnvironment env ;
+				std::function< void() > setUp_child_process ;
+			};
+
+			/*
+			 * Lives on the thread of a Task::process::multiplexer and owns a process started
+			 * there. "function" is called there once with the result and the watcher is
+			 * deleted after the process is gone. The arguments are moved to the multiplexer's
+			 * thread because the watcher is created after start() returned.
+			 */
+			class watcher : public QObject
+			{
+			public:
+				static void start( Task::process::multiplexer& m,
+						   Task::process::detail::arguments a,
+						   Task::detail::move_only_function< void( result ) > function )
+				{
+					m.post( [ a = std::move( a ),function = std::move( function ) ]()mutable{
+
+						new watcher( a,std::move( function ) ) ;
+					} ) ;
+				}
+			private:
+				watcher( const Task::process::detail::arguments& a,
+					 Task::detail::move_only_function< void( result ) > function ) :
+					m_function( std::move( function ) ),
+					m_process( a.setUp_child_process,a.env ),
+					m_stdOut( a.stream.std_out(),a.stream ),
+					m_stdError( a.stream.std_error(),a.stream )
+				{
+					using finished = void( QProcess::* )( int,QProcess::ExitStatus ) ;
+
+					QObject::connect( &m_process,&QProcess::readyReadStandardOutput,this,[ this ](){
+
+						m_stdOut.add( m_process.readAllStandardOutput() ) ;
+					} ) ;
+
+					QObject::connect( &m_process,&QProcess::readyReadStandardError,this,[ this ](){
+
+						m_stdError.add( m_process.readAllStandardError() ) ;
+					} ) ;
+
+					QObject::connect( &m_process,static_cast< finished >( &QProcess::finished ),this,[ this ]( int,QProcess::ExitStatus ){
+
+						this->done( true ) ;
+
+						this->deleteLater() ;
+					} ) ;
+
+					QObject::connect( &m_process,&QProcess::errorOccurred,this,[ this ]( QProcess::ProcessError e ){
+
+						if( e == QProcess::FailedToStart ){
+
+							this->done( false ) ;
+
+							this->deleteLater() ;
+						}
+					} ) ;
+
+					if( a.waitTime != -1 ){
+
+						QTimer::singleShot( a.waitTime,this,[ this ](){
+
+							this->done( false ) ;
+
+							m_process.kill() ;
+						} ) ;
+					}
+
+					Task::process::detail::start( m_process,a.cmd,a.args ) ;
+
+					if( !a.password.isEmpty() ){
+
+						m_process.write( a.password ) ;
+						m_process.closeWriteChannel() ;
+					}
+				}
+				void done( bool finished )
+				{
+					if( m_done ){
+
+						return ;
+					}
+
+					m_done = true ;
+
+					m_stdOut.add( m_process.readAllStandardOutput() ) ;
+					m_stdError.add( m_process.readAllStandardError() ) ;
+
+					m_function( result( m_stdOut.finish(),
+							    m_stdError.finish(),
+							    m_process.exitCode(),
+							    m_process.exitStatus(),
+							    finished,
+							    Task::process::detail::output::error( m_stdOut,m_stdError ) ) ) ;
+				}
+				Task::detail::move_only_function< void( result ) > m_function ;
+				Process m_process ;
+				Task::process::detail::output m_stdOut ;
+				Task::process::detail::output m_stdError ;
+				bool m_done = false ;
+			};
+
+			/*
+			 * Powers futures returned by Task::process::run() with a multiplexer. It lives on
+			 * the thread that created it and the result is delivered from the multiplexer's thread.
+			 */
+			class runner : public QObject,
+				       public Task::detail::task< result >,
+				       public Task::detail::recyclable
+			{
+			public:
+				runner( Task::process::multiplexer& m,Task::process::detail::arguments a ) :
+					m_multiplexer( m ),
+					m_arguments( std::move( a ) ),
+					m_future( nullptr,this )
+				{
+				}
+				Task::future< result >& Future()
+				{
+					return m_future ;
+				}
+			private:
+				void task_start() override
+				{
+					Task::process::detail::watcher::start( m_multiplexer,std::move( m_arguments ),[ this ]( result e ){
+
+						m_result = std::move( e ) ;
+
+						m_delivery.deliver( m_future,this,m_result ) ;
+
+						this->deleteLater() ;
+					} ) ;
+				}
+				void task_cancel() override
+				{
+					this->deleteLater() ;
+				}
+				result task_get() override
+				{
+					this->deleteLater() ;
+
+					const auto& a = m_arguments ;
+
+					return Task::process::detail::task( a.cmd,
+									    a.args,
+									    a.stream,
+									    a.waitTime,
+									    a.password,
+									    a.env,
+									    a.setUp_child_process )() ;
+				}
+				Task::process::multiplexer& m_multiplexer ;
+				Task::process::detail::arguments m_arguments ;
+				Task::future< result > m_future ;
+				result m_result ;
+				Task::detail::delivery m_delivery ;
+			};
+
+			static inline Task::future< result >& run( Task::process::multiplexer& m,
+								   Task::process::detail::arguments a )
+			{
+				auto e = new Task::process::detail::runner( m,std::move( a ) ) ;
+
+				return e->Future() ;
+			}
+		}
+
+		static inline Task::future< result >& run( const QString& cmd,
+		                                           const QStringList& args,
+							   int waitTime = -1,
+							   const QByteArray& password = QByteArray(),
+							   const QProcessEnvironment& env = QProcessEnvironment(),
+							   std::function< void() > setUp_child_process = [](){} )
+		{
+			return Task::run( Task::process::detail::task( cmd,
+								       args,
+								       waitTime,
+								       password,
+								       env,
+								       std::move( setUp_child_process ) ) ) ;
+		}
+
+		/*
+		 * Same as above but the process is waited on by a task that runs on the given executor.
+		 */
+		static inline Task::future< result >& run( Task::executor& executor,
+							   const QString& cmd,
+		                                           const QStringList& args,
+							   int waitTime = -1,
+							   const QByteArray& password = QByteArray(),
+							   const QProcessEnvironment& env = QProcessEnvironment(),
+							   std::function< void() > setUp_child_process = [](){} )
+		{
+			return Task::run( executor,Task::process::detail::task( cmd,
+										args,
+										waitTime,
+										password,
+										env,
+										std::move( setUp_child_process ) ) ) ;
+		}
+
+		static inline Task::future< result >& run( const QString& cmd,const QByteArray& password )
+		{
+			return Task::process::run( cmd,{},-1,password ) ;
+		}
 
-	template< typename ... T >
-	Task::future< void >& run_tasks( Task::future< void >& s,T&& ... t )
-	{
-		auto& e = Task::detail::future< void >() ;
-		Task::detail::add_future( e,s,std::forward<T>( t ) ... ) ;
-		return e ;
-	}
+		static inline Task::future< result >& run( const QString& cmd,
+							   const QStringList& args,
+							   const QByteArray& password )
+		{
+			return Task::process::run( cmd,args,-1,password ) ;
+		}
 
-	template< typename ... T >
-	Task::future< void >& run( pair< void > s,T ... t )
-	{
-		auto& e = Task::detail::future< void >() ;
-		Task::detail::add_pair_void( e,std::move( s ),std::move( t ) ... ) ;
-		return e ;
-	}
+		static inline Task::future< result >& run( Task::executor& executor,
+							   const QString& cmd,
+							   const QByteArray& password )
+		{
+			return Task::process::run( executor,cmd,{},-1,password ) ;
+		}
 
-	template< typename E,typename ... T >
-	Task::future< E >& run( pair< E > s,T ... t )
-	{
-		auto& e = Task::detail::future< E >() ;
-		Task::detail::add_pair( e,std::move( s ),std::move( t ) ... ) ;
-		return e ;
-	}
+		static inline Task::future< result >& run( Task::executor& executor,
+							   const QString& cmd,
+							   const QStringList& args,
+							   const QByteArray& password )
+		{
+			return Task::process::run( executor,cmd,args,-1,password ) ;
+		}
 
-	/*
-	 *
-	 * A few useful helper functions
-	 *
-	 */
-	template< typename Fn >
-	Task::detail::result_of<Fn> await( Fn function )
-	{
-		return Task::run( std::move( function ) ).await() ;
-	}
+		/*
+		 * Runs a process whose output is handed over while it runs,see Task::process::stream.
+		 */
+		static inline Task::future< result >& run( const QString& cmd,
+							   const QStringList& args,
+							   const Task::process::stream& stream,
+							   int waitTime = -1,
+							   const QByteArray& password = QByteArray(),
+							   const QProcessEnvironment& env = QProcessEnvironment(),
+							   std::function< void() > setUp_child_process = [](){} )
+		{
+			return Task::run( Task::process::detail::task( cmd,
+								       args,
+								       stream,
+								       waitTime,
+								       password,
+								       env,
+								       std::move( setUp_child_process ) ) ) ;
+		}
 
-	template< typename Fn,typename ... Args >
-	Task::detail::result_of<Fn,Args ...> await( Fn function,Args ... args )
-	{
-		return Task::run( std::move( function ),std::move( args ) ... ).await() ;
-	}
-	template< typename T >
-	T await( Task::future<T>& e )
-	{
-		return e.await() ;
-	}
+		static inline Task::future< result >& run( Task::executor& executor,
+							   const QString& cmd,
+							   const QStringList& args,
+							   const Task::process::stream& stream,
+							   int waitTime = -1,
+							   const QByteArray& password = QByteArray(),
+							   const QProcessEnvironment& env = QProcessEnvironment(),
+							   std::function< void() > setUp_child_process = [](){} )
+		{
+			return Task::run( executor,Task::process::detail::task( cmd,
+										args,
+										stream,
+										waitTime,
+										password,
+										env,
+										std::move( setUp_child_process ) ) ) ;
+		}
 
-	template< typename T >
-	T await( std::future<T> t )
-	{
-		return Task::await<T>( [ & ](){ return t.get() ; } ) ;
-	}
+		/*
+		 * Runs a process that is waited on by the thread of the multiplexer,usually
+		 * Task::process::io_thread(),without a thread of its own. The future resolves the same
+		 * way as above and a process that did not finish within "waitTime" is killed.
+		 */
+		static inline Task::future< result >& run( Task::process::multiplexer& m,
+							   const QString& cmd,
+							   const QStringList& args,
+							   int waitTime = -1,
+							   const QByteArray& password = QByteArray(),
+							   const QProcessEnvironment& env = QProcessEnvironment(),
+							   std::function< void() > setUp_child_process = [](){} )
+		{
+			return Task::process::detail::run( m,{ cmd,
+							       args,
+							       Task::process::stream(),
+							       waitTime,
+							       password,
+							       env,
+							       std::move( setUp_child_process ) } ) ;
+		}
 
-	/*
-	 * These methods run their arguments in a separate thread and does not offer
-	 * continuation feature.Useful when wanting to just run a function in a
-	 * different thread.
-	 */
-	template< typename Fn >
-	void exec( Fn function )
-	{
-		Task::run( std::move( function ) ).start() ;
-	}
-	template< typename Fn,typename ... Args >
-	void exec( Fn function,Args ... args )
-	{
-		Task::run( std::move( function ),std::move( args ) ... ).start() ;
-	}
-	template< typename T >
-	void exec( Task::future<T>& e )
-	{
-		e.start() ;
-	}
+		static inline Task::future< result >& run( Task::process::multiplexer& m,
+							   const QString& cmd,
+							   const QStringList& args,
+							   const Task::process::stream& stream,
+							   int waitTime = -1,
+							   const QByteArray& password = QByteArray(),
+							   const QProcessEnvironment& env = QProcessEnvironment(),
+							   std::function< void() > setUp_child_process = [](){} )
+		{
+			return Task::process::detail::run( m,{ cmd,
+							       args,
+							       stream,
+							       waitTime,
+							       password,
+							       env,
+							       std::move( setUp_child_process ) } ) ;
+		}
 
-	namespace process {
+		namespace detail
+		{
+			class pool_task ;
+		}
 
-		class result{
+		/*
+		 * Starts processes on a multiplexer,Task::process::io_thread() by default,with at most
+		 * "max_processes" of them running at the same time. Processes that are started while all
+		 * slots are taken wait in a queue and the one with the highest priority goes next,those
+		 * with the same priority go in the order they were started.
+		 *
+		 * A process is queued when its future is started,by .then(),.await() or .get(),and the
+		 * pool must outlive all processes started through it.
+		 */
+		class pool
+		{
 		public:
-			result() = default ;
-			result( int exit_code ) :
-				m_finished( true ),
-				m_exitCode( exit_code ),
-				m_exitStatus( 0 )
+			struct statistics
 			{
-			}
-			template< typename E,typename F >
-			result( E&& std_out,
-				F&& std_error,
-				int exit_code,
-				int exit_status,
-				bool finished ) :
-				m_stdOut( std::forward<E>( std_out ) ),
-				m_stdError( std::forward<F>( std_error ) ),
-				m_finished( finished ),
-				m_exitCode( exit_code ),
-				m_exitStatus( exit_status )
+				/*
+				 * Processes that are running and those that wait for a slot.
+				 */
+				std::size_t running ;
+				std::size_t queued ;
+				/*
+				 * The number of processes that were started since the pool was created.
+				 */
+				std::uint64_t started ;
+				/*
+				 * The total and the longest time,in nanoseconds,processes waited for a slot.
+				 */
+				std::uint64_t wait_time ;
+				std::uint64_t max_wait_time ;
+			};
+
+			pool( std::size_t max_processes = 0 ) :
+				pool( Task::process::io_thread(),max_processes )
 			{
 			}
-			result( QProcess& e,int s )
+			pool( Task::process::multiplexer& m,std::size_t max_processes = 0 ) :
+				m_multiplexer( m ),
+				m_max( max_processes > 0 ? max_processes : pool::ideal() )
 			{
-				m_finished   = e.waitForFinished( s ) ;
-				m_stdOut     = e.readAllStandardOutput() ;
-				m_stdError   = e.readAllStandardError() ;
-				m_exitCode   = e.exitCode() ;
-				m_exitStatus = e.exitStatus() ;
 			}
-			const QByteArray& std_out() const
+			pool( const pool& ) = delete ;
+			pool& operator=( const pool& ) = delete ;
+
+			Task::future< result >& run( const QString& cmd,
+						     const QStringList& args,
+						     int waitTime = -1,
+						     const QByteArray& password = QByteArray(),
+						     const QProcessEnvironment& env = QProcessEnvironment(),
+						     std::function< void() > setUp_child_process = [](){} )
 			{
-				return m_stdOut ;
+				return this->run( 0,cmd,args,waitTime,password,env,std::move( setUp_child_process ) ) ;
 			}
-			const QByteArray& std_error() const
+			Task::future< result >& run( const QString& cmd,
+						     const QStringList& args,
+						     const Task::process::stream& stream,
+						     int waitTime = -1,
+						     const QByteArray& password = QByteArray(),
+						     const QProcessEnvironment& env = QProcessEnvironment(),
+						     std::function< void() > setUp_child_process = [](){} )
 			{
-				return m_stdError ;
+				return this->run( 0,cmd,args,stream,waitTime,password,env,std::move( setUp_child_process ) ) ;
 			}
-			bool finished() const
+			/*
+			 * Processes with a higher priority leave the queue first,the default priority is 0.
+			 */
+			Task::future< result >& run( int priority,
+						     const QString& cmd,
+						     const QStringList& args,
+						     int waitTime = -1,
+						     const QByteArray& password = QByteArray(),
+						     const QProcessEnvironment& env = QProcessEnvironment(),
+						     std::function< void() > setUp_child_process = [](){} )
 			{
-				return m_finished ;
+				return this->run( priority,cmd,args,Task::process::stream(),waitTime,password,env,std::move( setUp_child_process ) ) ;
 			}
-			bool success() const
+			Task::future< result >& run( int priority,
+						     const QString& cmd,
+						     const QStringList& args,
+						     const Task::process::stream& stream,
+						     int waitTime = -1,
+						     const QByteArray& password = QByteArray(),
+						     const QProcessEnvironment& env = QProcessEnvironment(),
+						     std::function< void() > setUp_child_process = [](){} ) ;
+
+			Task::process::pool::statistics stats() const
 			{
-				return m_exitCode == 0 &&
-				       m_exitStatus == QProcess::NormalExit &&
-				       m_finished == true ;
+				QMutexLocker m( &m_mutex ) ;
+
+				return { m_running,m_queue.size(),m_started,m_wait_time,m_max_wait_time } ;
 			}
-			bool failed() const
+			std::size_t max_processes() const
 			{
-				return !this->success() ;
+				return m_max ;
 			}
-			int exit_code() const
+			friend class Task::process::detail::pool_task ;
+		private:
+			using clock = std::chrono::steady_clock ;
+
+			struct entry
 			{
-				return m_exitCode ;
+				int priority ;
+				std::uint64_t sequence ;
+				clock::time_point queued ;
+				Task::process::detail::pool_task * task ;
+
+				bool operator<( const entry& e ) const
+				{
+					if( priority != e.priority ){
+
+						return priority < e.priority ;
+					}else{
+						return sequence > e.sequence ;
+					}
+				}
+			};
+			static std::size_t ideal()
+			{
+				auto e = QThread::idealThreadCount() ;
+
+				return e > 0 ? static_cast< std::size_t >( e ) : 1 ;
 			}
-			int exit_status() const
+			void enqueue( Task::process::detail::pool_task& task,int priority ) ;
+			void finished() ;
+			void started( clock::time_point queued )
 			{
-				return m_exitStatus ;
+				auto e = static_cast< std::uint64_t >( std::chrono::duration_cast< std::chrono::nanoseconds >( clock::now() - queued ).count() ) ;
+
+				m_running++ ;
+				m_started++ ;
+				m_wait_time += e ;
+
+				if( e > m_max_wait_time ){
+
+					m_max_wait_time = e ;
+				}
 			}
-		private:
-			QByteArray m_stdOut ;
-			QByteArray m_stdError ;
-			bool m_finished = false ;
-			int m_exitCode = 255 ;
-			int m_exitStatus = 255 ;
+			Task::process::multiplexer& m_multiplexer ;
+			std::size_t m_max ;
+			std::priority_queue< entry > m_queue ;
+			std::uint64_t m_sequence = 0 ;
+			std::size_t m_running = 0 ;
+			std::uint64_t m_started = 0 ;
+			std::uint64_t m_wait_time = 0 ;
+			std::uint64_t m_max_wait_time = 0 ;
+			mutable QMutex m_mutex ;
 		};
 
-		static inline Task::future< result >& run( const QString& cmd,
-		                                           const QStringList& args,
-							   int waitTime = -1,
-							   const QByteArray& password = QByteArray(),
-							   const QProcessEnvironment& env = QProcessEnvironment(),
-							   std::function< void() > setUp_child_process = [](){} )
+		namespace detail
 		{
-			return Task::run( [ = ](){
+			/*
+			 * Powers futures returned by Task::process::pool::run(),the process is started on the
+			 * pool's multiplexer once the pool gives it a slot.
+			 */
+			class pool_task : public QObject,
+					  public Task::detail::task< result >,
+					  public Task::detail::recyclable
+			{
+			public:
+				pool_task( Task::process::pool& p,int priority,Task::process::detail::arguments a ) :
+					m_pool( p ),
+					m_priority( priority ),
+					m_arguments( std::move( a ) ),
+					m_future( nullptr,this )
+				{
+				}
+				Task::future< result >& Future()
+				{
+					return m_future ;
+				}
+				void launch()
+				{
+					Task::process::detail::watcher::start( m_pool.m_multiplexer,std::move( m_arguments ),[ this ]( result e ){
 
-				class Process : public QProcess{
-				public:
-					Process( std::function< void() > function,
-						 const QProcessEnvironment& env ) :
-						 m_function( std::move( function  ) )
-					{
-						this->setProcessEnvironment( env ) ;
-					}
-				protected:
-					void setupChildProcess()
-					{
-						m_function() ;
-					}
-				private:
-					std::function< void() > m_function ;
+						m_result = std::move( e ) ;
 
-				} exe( std::move( setUp_child_process ),env ) ;
+						m_pool.finished() ;
 
-				if( args.isEmpty() ){
+						if( m_loop ){
 
-					#if QT_VERSION < QT_VERSION_CHECK( 5,15,0 )
-						exe.start( cmd ) ;
-					#else
-						exe.start( cmd,args ) ;
-					#endif
-				}else{
-					exe.start( cmd,args ) ;
+							m_finished = true ;
+
+							m_loop->exit() ;
+
+						}else if( m_wait ){
+
+							m_done.release() ;
+						}else{
+							m_delivery.deliver( m_future,this,m_result ) ;
+
+							this->deleteLater() ;
+						}
+					} ) ;
+				}
+			private:
+				void task_start() override
+				{
+					m_pool.enqueue( *this,m_priority ) ;
+				}
+				void task_cancel() override
+				{
+					this->deleteLater() ;
 				}
+				result task_get() override
+				{
+					if( m_pool.m_multiplexer.current() ){
 
-				if( !password.isEmpty() ){
+						/*
+						 * Processes of the pool are waited on by this thread,an event
+						 * loop keeps them going while this one waits for a slot and runs.
+						 */
+						QEventLoop loop ;
 
-					exe.waitForStarted( waitTime ) ;
-					exe.write( password ) ;
-					exe.closeWriteChannel() ;
+						m_loop = &loop ;
+
+						m_pool.enqueue( *this,m_priority ) ;
+
+						if( !m_finished ){
+
+							loop.exec() ;
+						}
+					}else{
+						m_wait = true ;
+
+						m_pool.enqueue( *this,m_priority ) ;
+
+						m_done.acquire() ;
+					}
+
+					this->deleteLater() ;
+
+					return std::move( m_result ) ;
 				}
+				Task::process::pool& m_pool ;
+				int m_priority ;
+				Task::process::detail::arguments m_arguments ;
+				Task::future< result > m_future ;
+				result m_result ;
+				bool m_wait = false ;
+				bool m_finished = false ;
+				QEventLoop * m_loop = nullptr ;
+				QSemaphore m_done ;
+				Task::detail::delivery m_delivery ;
+			};
+		}
 
-				return result( exe,waitTime ) ;
-			} ) ;
+		inline Task::future< result >& pool::run( int priority,
+							  const QString& cmd,
+							  const QStringList& args,
+							  const Task::process::stream& stream,
+							  int waitTime,
+							  const QByteArray& password,
+							  const QProcessEnvironment& env,
+							  std::function< void() > setUp_child_process )
+		{
+			auto e = new Task::process::detail::pool_task( *this,priority,{ cmd,
+											 args,
+											 stream,
+											 waitTime,
+											 password,
+											 env,
+											 std::move( setUp_child_process ) } ) ;
+			return e->Future() ;
 		}
 
-		static inline Task::future< result >& run( const QString& cmd,const QByteArray& password )
+		inline void pool::enqueue( Task::process::detail::pool_task& task,int priority )
 		{
-			return Task::process::run( cmd,{},-1,password ) ;
+			m_mutex.lock() ;
+
+			if( m_running < m_max ){
+
+				this->started( clock::now() ) ;
+
+				m_mutex.unlock() ;
+
+				task.launch() ;
+			}else{
+				m_queue.push( { priority,m_sequence++,clock::now(),&task } ) ;
+
+				m_mutex.unlock() ;
+			}
 		}
 
-		static inline Task::future< result >& run( const QString& cmd,
-							   const QStringList& args,
-							   const QByteArray& password )
+		inline void pool::finished()
 		{
-			return Task::process::run( cmd,args,-1,password ) ;
+			m_mutex.lock() ;
+
+			m_running-- ;
+
+			if( m_queue.empty() ){
+
+				m_mutex.unlock() ;
+			}else{
+				auto e = m_queue.top() ;
+
+				m_queue.pop() ;
+
+				this->started( e.queued ) ;
+
+				m_mutex.unlock() ;
+
+				e.task->launch() ;
+			}
 		}
 	}
 }